@@ -0,0 +1,165 @@
+/*
+ * bench_biquad.c
+ * Author: Trenton
+ * Date: 05/23/25
+ * Description: Host benchmark, cascade() against bq_cascade() and a
+ * BQ_FIXED_CASCADE() on the Lab 6 filter (2 sections). All run the same
+ * sine plus noise input, the
+ * outputs are compared sample by sample, then the average time per sample
+ * is printed with the share of one tick it takes at a few ISR rates.
+ * Then the same for all 10 analog inputs of connectors A, B and C, as 10
+ * bq_cascade() calls and as one bq_multi_run().
+ *
+ *   gcc -O2 -I. bench/bench_biquad.c biquad.c -lm
+ * add -DBQ_SCALAR for the scalar bq_multi_run(), -march=native for the
+ * widest vectors the host has.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <math.h>
+#include "biquad.h"
+
+/* definitions */
+#define N 200000	// samples per run
+#define REPS 20
+#define NCH 10		// AI A0-A3, B0-B3, C0-C1
+
+// Lab 6 filter, 2 sections
+static const struct biquad lab6[] = {
+	{1.0000e+00,  9.9999e-01, 0,
+	 1.0000e+00, -8.8177e-01, 0, 0, 0, 0, 0, 0},
+	{2.1878e-04,  4.3755e-04, 2.1878e-04,
+	 1.0000e+00, -1.8674e+00, 8.8220e-01, 0, 0, 0, 0, 0}
+};
+
+// the same filter as constants
+static const double lab6_c[2][5] = {
+	BQ_SECTION(1.0000e+00, 9.9999e-01, 0, 1.0000e+00, -8.8177e-01, 0),
+	BQ_SECTION(2.1878e-04, 4.3755e-04, 2.1878e-04, 1.0000e+00, -1.8674e+00, 8.8220e-01)
+};
+BQ_FIXED_CASCADE(lab6_filter, lab6_c, 2, -10, 10)
+
+static double x[N];
+static volatile double sink;	// keeps the timed loops from being optimized out
+
+// Functions ###################################################################
+
+static double now_ns(void){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+static double tick(double t){
+/* share of one tick in % */
+	return t*2e3/1e7;
+}
+
+static int multi(void){
+/* 10 channels, each its own copy of the filter with a different gain */
+	static Bq_Cascade one[NCH];
+	static Bq_Multi q;
+	struct biquad f[2];
+	double t0, t_one, t_multi, d, maxd = 0;
+	int i, r, ch;
+
+	bq_multi_init(&q, NCH, 2, -10, 10);
+	for (ch = 0; ch < NCH; ch++){
+		f[0] = lab6[0]; f[1] = lab6[1];
+		f[0].b0 *= 1 + 0.1*ch;
+		f[0].b1 *= 1 + 0.1*ch;
+		bq_init(&one[ch], f, 2, -10, 10);
+		bq_multi_set(&q, ch, f, 2);
+	}
+	for (i = 0; i < N; i++){
+		for (ch = 0; ch < NCH; ch++) q.x[ch] = x[(i + 97*ch) % N];
+		bq_multi_run(&q);
+		for (ch = 0; ch < NCH; ch++){
+			d = fabs(bq_cascade(&one[ch], q.x[ch]) - q.y[ch]);
+			if (d > maxd) maxd = d;
+		}
+	}
+	printf("%d channels, %d lanes%s\n", NCH, BQ_LANES,
+#ifdef BQ_SCALAR
+			" (BQ_SCALAR)"
+#else
+			""
+#endif
+			);
+	printf("  max |bq_cascade - bq_multi_run|: %.3g V\n", maxd);
+
+	t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < N; i++){
+			for (ch = 0; ch < NCH; ch++) sink = bq_cascade(&one[ch], x[i]);
+		}
+	}
+	t_one = (now_ns() - t0) / ((double)N * REPS);
+	t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < N; i++){
+			for (ch = 0; ch < NCH; ch++) q.x[ch] = x[i];
+			bq_multi_run(&q);
+			sink = q.y[0];
+		}
+	}
+	t_multi = (now_ns() - t0) / ((double)N * REPS);
+	printf("  %d x bq_cascade  %6.2f ns/tick  %.4f%% of a 2 kHz tick\n", NCH, t_one, tick(t_one));
+	printf("  bq_multi_run    %6.2f ns/tick  %.4f%% of a 2 kHz tick\n", t_multi, tick(t_multi));
+	return maxd > 0;
+}
+
+int main(void){
+	struct biquad f[2];
+	Bq_Cascade q;
+	double s[2][2] = {{0}};
+	double t0, t_old, t_new, t_fix, d, maxd = 0, maxf = 0;
+	const double rates[] = {2e3, 10e3, 50e3};
+	int i, r;
+
+	srand(477);
+	for (i = 0; i < N; i++)		// 10 Hz sine at 2 kHz, +-1 V, with noise
+		x[i] = sin(2*M_PI*10*i/2000.0) + 0.2*((double)rand()/RAND_MAX - 0.5);
+
+	// same output?
+	f[0] = lab6[0]; f[1] = lab6[1];
+	bq_init(&q, f, 2, -10, 10);
+	for (i = 0; i < N; i++){
+		d = cascade(x[i], f, 2, -10, 10);
+		maxd = fmax(maxd, fabs(d - bq_cascade(&q, x[i])));
+		maxf = fmax(maxf, fabs(d - lab6_filter(s, x[i])));
+	}
+	printf("max |cascade - bq_cascade| over %d samples: %.3g V\n", N, maxd);
+	printf("max |cascade - lab6_filter| over %d samples: %.3g V\n", N, maxf);
+
+	// time per sample
+	t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < N; i++) sink = cascade(x[i], f, 2, -10, 10);
+	}
+	t_old = (now_ns() - t0) / ((double)N * REPS);
+	t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < N; i++) sink = bq_cascade(&q, x[i]);
+	}
+	t_new = (now_ns() - t0) / ((double)N * REPS);
+	t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < N; i++) sink = lab6_filter(s, x[i]);
+	}
+	t_fix = (now_ns() - t0) / ((double)N * REPS);
+
+	printf("time per sample\n");
+	printf("  cascade     %6.2f ns\n", t_old);
+	printf("  bq_cascade  %6.2f ns\n", t_new);
+	printf("  lab6_filter %6.2f ns\n", t_fix);
+	printf("share of one tick\n");
+	for (i = 0; i < (int)(sizeof(rates) / sizeof(rates[0])); i++){
+		printf("  %5.0f kHz   cascade %.4f%%  bq_cascade %.4f%%  lab6_filter %.4f%%\n",
+				rates[i]/1e3, t_old*rates[i]/1e7, t_new*rates[i]/1e7, t_fix*rates[i]/1e7);
+	}
+	return (maxd > 1e-9) | (maxf > 1e-9) | multi();
+}
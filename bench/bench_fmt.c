@@ -0,0 +1,109 @@
+/*
+ * bench_fmt.c
+ * Author: Trenton
+ * Date: 05/16/25
+ * Description: Host benchmark, fmt_format() against vsnprintf() for the
+ * LCD formats the labs use. First the outputs are compared over random
+ * values, then the average time per call is measured. The worst case isn't
+ * measured, on a desktop it is set by the scheduler, not by the code.
+ *
+ *   gcc -O2 -I. bench/bench_fmt.c fmt.c -lm
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include "fmt.h"
+
+/* definitions */
+#define CHECKS 200000
+#define REPS 200000
+
+typedef int (*Formatter)(char *dst, int size, const char *format, ...);
+
+static volatile int sink;	// keeps the timed loops from being optimized out
+
+// Functions ###################################################################
+
+static int libc_format(char *dst, int size, const char *format, ...){
+	int n;
+	va_list args;
+	va_start(args, format);
+	n = vsnprintf(dst, size, format, args);
+	va_end(args);
+	return n;
+}
+
+static double now_ns(void){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+static double rnd_value(void){
+/* mixed magnitudes, like rpm, volts and gains */
+	double m = (double)rand() / RAND_MAX * 2 - 1;
+	switch (rand() % 4){
+	case 0: return m * 3000;
+	case 1: return m * 10;
+	case 2: return m * 0.01;
+	default: return rint(m * 1000) / 8;	// exact halves, tests round to even
+	}
+}
+
+static int check(const char *format){
+/* returns the number of values where the outputs differ */
+	char a[80], b[80];
+	int i, bad = 0;
+	double v;
+	for (i = 0; i < CHECKS; i++){
+		v = rnd_value();
+		libc_format(a, sizeof(a), format, v);
+		fmt_format(b, sizeof(b), format, v);
+		if (strcmp(a, b) != 0){
+			if (bad < 3) printf("  %-16s %.17g: libc \"%s\" fmt \"%s\"\n", format, v, a, b);
+			bad++;
+		}
+	}
+	return bad;
+}
+
+static void timeit(const char *name, Formatter f, const char *format, double v, int iv){
+	char b[80];
+	int r;
+	double t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		if (iv) sink += f(b, sizeof(b), format, iv);
+		else sink += f(b, sizeof(b), format, v);
+	}
+	printf("  %-5s %-16s %8.1f ns/call  \"%.24s\"\n",
+			name, format + (format[0] == '\f'), (now_ns() - t0) / REPS, b + (b[0] == '\f'));
+}
+
+int main(void){
+	int bad = 0;
+	const char *checked[] = {"%g", "%f", "%.3f", "%.2e", "%8.3g", "%-10.1f|", "%+g"};
+	unsigned i;
+
+	srand(477);
+	printf("output compared over %d random values\n", CHECKS);
+	for (i = 0; i < sizeof(checked) / sizeof(checked[0]); i++){
+		int b = check(checked[i]);
+		printf("  %-10s mismatches %d\n", checked[i], b);
+		bad += b;
+	}
+
+	printf("time per call\n");
+	timeit("libc", libc_format, "\f%d", 0, 1234567);
+	timeit("fmt", fmt_format, "\f%d", 0, 1234567);
+	timeit("libc", libc_format, "\fspeed: %g rpm", 1498.53125, 0);
+	timeit("fmt", fmt_format, "\fspeed: %g rpm", 1498.53125, 0);
+	timeit("libc", libc_format, "%f", 3.14159265358979, 0);
+	timeit("fmt", fmt_format, "%f", 3.14159265358979, 0);
+	timeit("libc", libc_format, "%f", 1e300, 0);	// 300 digits from printf
+	timeit("fmt", fmt_format, "%f", 1e300, 0);
+	return bad != 0;
+}
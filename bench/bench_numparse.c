@@ -0,0 +1,93 @@
+/*
+ * bench_numparse.c
+ * Author: Trenton
+ * Date: 05/09/25
+ * Description: Host benchmark, num_parse() against the double_in() checks
+ * it replaced (strpbrk/strchr/strrchr, then sscanf). Both paths must give
+ * the same accept/reject and the same value for every input.
+ *
+ *   gcc -O2 -Isim -I. bench/bench_numparse.c numparse.c sim/myrio_sim.c sim/T1_sim.c sim/matlabfiles.c -lpthread -lm
+ */
+
+/* includes */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "numparse.h"
+
+/* definitions */
+#define REPS 200000
+
+static const char *inputs[] = {
+		"0", "7", "42", "-5", "1000", "-250000", "3.14159", "-0.001",
+		"12.5", ".5", "-.75", "99999999", "123456.789012", "2.", "0.0",
+		"9007199254740993", "-1234567890.12345678", ".123456789012345678", "120117.523947245031",
+		"", "-", ".", "-.", "1.2.3", "4-5", "--1", "1[", "]"
+};
+#define NIN ((int)(sizeof(inputs) / sizeof(inputs[0])))
+
+static volatile double sink;	// keeps the timed loops from being optimized out
+
+// Functions ###################################################################
+
+static int old_path(const char *buffer, double *value){
+/* double_in() before num_parse(), returns 1 if accepted
+ * "-", "." and "-." got through the checks and sscanf() left value unset. */
+	if (buffer[0] == '\0') return 0;
+	if ((strpbrk(buffer,"[]") != NULL) || (strpbrk(buffer+1,"-") != NULL)
+			|| (strchr(buffer,'.') != NULL && strchr(buffer,'.') != strrchr(buffer,'.'))){
+		return 0;
+	}
+	sscanf(buffer, "%lf", value);
+	return 1;
+}
+
+static int new_path(const char *buffer, double *value){
+	Num_Value v;
+	if (num_parse(buffer, &v) != NUM_OK) return 0;
+	*value = num_double(&v);
+	return 1;
+}
+
+static double ns_per_op(int (*parse)(const char*, double*)){
+	struct timespec t0, t1;
+	int r, i;
+	double v = 0, sum = 0;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < NIN; i++){
+			if (parse(inputs[i], &v)) sum += v;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	sink = sum;
+	return ((t1.tv_sec - t0.tv_sec)*1e9 + (t1.tv_nsec - t0.tv_nsec)) / ((double)REPS * NIN);
+}
+
+int main(void){
+	int i, ok_old, ok_new, bad = 0;
+	double a, b, t_old, t_new;
+	Num_Value v;
+
+	// same results, except the "-." family the old checks let through
+	for (i = 0; i < NIN; i++){
+		a = b = 0;
+		ok_old = old_path(inputs[i], &a);
+		ok_new = new_path(inputs[i], &b);
+		if (num_parse(inputs[i], &v) == NUM_NODIGITS){
+			printf("fixed:  \"%s\" old accepted, new %s\n", inputs[i], num_error_text(NUM_NODIGITS));
+		}
+		else if (ok_old != ok_new || (ok_new && a != b)){
+			printf("differ: \"%s\" old %d %.17g new %d %.17g (%s)\n", inputs[i],
+					ok_old, a, ok_new, b, num_error_text(num_parse(inputs[i], &v)));
+			bad++;
+		}
+	}
+
+	t_old = ns_per_op(old_path);
+	t_new = ns_per_op(new_path);
+	printf("inputs %d, mismatches %d\n", NIN, bad);
+	printf("old  %7.1f ns/input\n", t_old);
+	printf("new  %7.1f ns/input  (%.1fx)\n", t_new, t_old / t_new);
+	return bad != 0;
+}
@@ -0,0 +1,175 @@
+/*
+ * bench_qbiquad.c
+ * Author: Trenton
+ * Date: 05/30/25
+ * Description: Host benchmark, the fixed-point cascade (qbiquad.c) against
+ * cascade() for a few Q formats. For each format it prints the quantizer
+ * report, the output error against cascade() in volts and in 12 bit DAC
+ * steps, and the time per sample, from volts to volts (qbq_cascade()) and
+ * from Q to Q (qbq_run()).
+ *
+ * Two filters: the Lab 6 filter on vin recorded by Lab 6 (pass the .mat
+ * file, the 500 points are played in a loop) or on a 10 Hz sine with noise
+ * if there is no file, and the Lab 7 PI (Kp 0.104, Ki 2.07, BTI 5 ms) on
+ * a made up speed error.
+ *
+ *   gcc -O2 -I. bench/bench_qbiquad.c qbiquad.c biquad.c -lm
+ *   ./a.out Lab6_trenton_sine.mat
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include "biquad.h"
+#include "qbiquad.h"
+
+/* definitions */
+#define N 200000	// samples per run
+#define REPS 10
+#define DAC_STEP (20.0 / 4096)	// volts per step, 12 bits over +-10 V
+
+/* one fixed-point format to try */
+typedef struct {
+	int qx, qc;
+	double fs;		// volts
+} Format;
+
+static double x[N];
+static double yd[N];	// cascade() output
+static int32_t xq[N];	// x in Q(qx), like codes straight from the ADC
+static volatile double sink;	// keeps the timed loops from being optimized out
+
+// Functions ###################################################################
+
+static double now_ns(void){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+static int read_vin(const char *file, double *v, int max){
+/* the "vin" matrix of a MAT v5 file from matlabfiles.c, returns its length
+ * or 0. Only what matlabfiles writes: uncompressed, double, little endian */
+	FILE *fp = fopen(file, "rb");
+	uint32_t tag[2], sub[2], dims[2], n = 0;
+	char name[32];
+	long next;
+	if (!fp) return 0;
+	fseek(fp, 128, SEEK_SET);
+	while (n == 0 && fread(tag, 4, 2, fp) == 2){
+		next = ftell(fp) + tag[1];
+		if (tag[0] == 14 && fread(sub, 4, 2, fp) == 2		// miMATRIX, flags tag
+				&& fseek(fp, 8, SEEK_CUR) == 0			// flags
+				&& fread(sub, 4, 2, fp) == 2 && sub[1] == 8	// dims tag
+				&& fread(dims, 4, 2, fp) == 2
+				&& fread(sub, 4, 2, fp) == 2 && sub[1] < sizeof(name)){	// name tag
+			if (fread(name, 1, (sub[1] + 7) & ~7u, fp) == ((sub[1] + 7) & ~7u)){
+				name[sub[1]] = '\0';
+				if (strcmp(name, "vin") == 0 && fread(sub, 4, 2, fp) == 2 && sub[0] == 9){
+					n = dims[0] * dims[1];
+					if (n > (uint32_t)max) n = max;
+					n = fread(v, 8, n, fp);
+				}
+			}
+		}
+		fseek(fp, next, SEEK_SET);
+	}
+	fclose(fp);
+	return n;
+}
+
+static void run(const char *title, const struct biquad *design, int ns,
+		const Format *fmt, int nfmt){
+	struct biquad f[BQ_MAX_SECTIONS];
+	static Qbq_Cascade q;
+	Qbq_Error e;
+	double t0, t_d, t_q, t_r, d, maxd, sum;
+	int i, k, r;
+
+	// double reference
+	memcpy(f, design, ns * sizeof(*f));
+	for (i = 0; i < N; i++) yd[i] = cascade(x[i], f, ns, -10, 10);
+	t0 = now_ns();
+	for (r = 0; r < REPS; r++){
+		for (i = 0; i < N; i++) sink = cascade(x[i], f, ns, -10, 10);
+	}
+	t_d = (now_ns() - t0) / ((double)N * REPS);
+
+	printf("%s, cascade() %.2f ns/sample\n", title, t_d);
+	printf("  Qx  Qc    fs | coef err  pole err  resp err      gain | max err V  steps  rms V     |"
+			" ns/sample volts, Q\n");
+	for (k = 0; k < nfmt; k++){
+		if (qbq_init(&q, design, ns, fmt[k].qx, fmt[k].qc, fmt[k].fs, -10, 10) < 0){
+			printf("  Q%-2d Q%-2d %5g | coefficients don't fit\n", fmt[k].qx, fmt[k].qc, fmt[k].fs);
+			continue;
+		}
+		qbq_quantize(&q, design, &e);
+		maxd = sum = 0;
+		for (i = 0; i < N; i++){
+			d = fabs(qbq_cascade(&q, x[i]) - yd[i]);
+			maxd = fmax(maxd, d);
+			sum += d*d;
+		}
+		qbq_reset(&q);
+		t0 = now_ns();
+		for (r = 0; r < REPS; r++){
+			for (i = 0; i < N; i++) sink = qbq_cascade(&q, x[i]);
+		}
+		t_q = (now_ns() - t0) / ((double)N * REPS);
+		for (i = 0; i < N; i++) xq[i] = qbq_from_volts(&q, x[i]);
+		t0 = now_ns();
+		for (r = 0; r < REPS; r++){
+			for (i = 0; i < N; i++) sink = qbq_run(&q, xq[i]);
+		}
+		t_r = (now_ns() - t0) / ((double)N * REPS);
+		printf("  Q%-2d Q%-2d %5g | %8.1e  %8.1e  %8.1e  %8.3g | %9.2e %6.2f  %9.2e | %6.2f %6.2f\n",
+				fmt[k].qx, fmt[k].qc, fmt[k].fs, e.coef, e.pole, e.resp, e.gain,
+				maxd, maxd / DAC_STEP, sqrt(sum / N), t_q, t_r);
+	}
+}
+
+int main(int argc, char **argv){
+	static const struct biquad lab6[] = {
+		{1.0000e+00,  9.9999e-01, 0,
+		 1.0000e+00, -8.8177e-01, 0, 0, 0, 0, 0, 0},
+		{2.1878e-04,  4.3755e-04, 2.1878e-04,
+		 1.0000e+00, -1.8674e+00, 8.8220e-01, 0, 0, 0, 0, 0}
+	};
+	const double Kp = 0.104, Ki = 2.07, T = 0.005;
+	const struct biquad pi[] = {
+		{Kp + Ki*T/2, -Kp + Ki*T/2, 0, 1, -1, 0, 0, 0, 0, 0, 0}
+	};
+	// the first Lab 6 section has a DC gain of about 17, so fs needs room for 17 x vin
+	const Format f6[] = {
+		{15, 14, 32}, {15, 29, 32}, {15, 29, 10}, {31, 29, 32}, {31, 24, 32}
+	};
+	const Format f7[] = {
+		{15, 14, 64}, {15, 29, 64}, {31, 29, 64}
+	};
+	static double rec[4096];
+	int i, n = 0;
+
+	if (argc > 1) n = read_vin(argv[1], rec, 4096);
+	if (n > 0){
+		printf("vin: %d points from %s, looped\n", n, argv[1]);
+		for (i = 0; i < N; i++) x[i] = rec[i % n];
+	}
+	else {
+		printf("vin: 10 Hz sine at 2 kHz, +-1 V, with noise\n");
+		srand(477);
+		for (i = 0; i < N; i++)
+			x[i] = sin(2*M_PI*10*i/2000.0) + 0.2*((double)rand()/RAND_MAX - 0.5);
+	}
+	run("Lab 6 filter", lab6, 2, f6, sizeof(f6) / sizeof(f6[0]));
+
+	// speed error in rad/s: a zero mean mix, so the integrator doesn't wind up
+	srand(477);
+	for (i = 0; i < N; i++)
+		x[i] = 20*sin(2*M_PI*i/400.0) + 5*((double)rand()/RAND_MAX - 0.5);
+	run("Lab 7 PI", pi, 1, f7, sizeof(f7) / sizeof(f7[0]));
+	return 0;
+}
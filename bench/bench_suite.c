@@ -0,0 +1,277 @@
+/*
+ * bench_suite.c
+ * Author: Trenton
+ * Date: 07/11/25
+ * Description: Host benchmark suite for the driver and DSP hot paths, run
+ * against the simulated myRIO calls. Each benchmark runs one call in a
+ * loop, long enough to take about 0.2 s, and reports
+ * 	ns/op		host time per call
+ * 	op/s		calls per second
+ * 	alloc/op	malloc() calls per call, and bytes
+ * 	reg/op		FPGA register accesses per call (myrio_sim.c counts them)
+ * 	uart/op		bytes sent to the LCD per call
+ * The last two are what the call costs on the myRIO, where each register
+ * access and UART byte takes far longer than the code around it; the host
+ * time only compares code paths against each other.
+ *
+ * The T1 routines are the simulated library versions (sim/T1_sim.c, same
+ * code as the labs'), next to the shared modules that replaced them. vel()
+ * is Lab 4's, so main-4.c is built as an object first.
+ *
+ *   gcc -O2 -Isim -I. -Dmain=lab4_main -c main-4.c -o lab4.o
+ *   gcc -O2 -Isim -I. bench/bench_suite.c lab4.o biquad.c lcd.c fmt.c keypad.c regio.c numparse.c lineedit.c timing.c telem.c capture.c pwm.c istat.c rtthread.c workq.c sim/myrio_sim.c sim/T1_sim.c sim/matlabfiles.c -lpthread -lm
+ *   ./a.out [-f name] [-o results.csv] [-c baseline.csv]
+ * -f runs only the benchmarks whose name contains name, -o saves the
+ * results as CSV (name,ns_op,op_s,alloc_op,bytes_op,reg_op,uart_op) and -c
+ * prints the ns/op, reg/op and uart/op of a saved run next to each result,
+ * with the ratio new/old of ns/op.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include "T1.h"
+#include "biquad.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "numparse.h"
+
+/* definitions */
+#define MIN_NS 200000000.0	// time each benchmark for at least 0.2 s
+#define NX 1024				// input samples, power of 2
+#define NKEYS 200			// presses for getkey(), the sim scripts up to 256
+#define MAXB 16
+
+/* one benchmark: setup(n) before the timed n calls of op(i), n = 0 if the
+ * count is picked by timing, or fixed by the benchmark */
+typedef struct {
+	const char *name;
+	void (*setup)(int n);
+	void (*op)(int i);
+	int n;
+} Bench;
+
+typedef struct {
+	char name[32];
+	double ns, ops, allocs, bytes, regs, uart;
+} Result;
+
+double vel(void);	// main-4.c
+
+static double x[NX];			// sine plus noise, volts
+static struct biquad lab6[] = {
+	{1.0000e+00,  9.9999e-01, 0,
+	 1.0000e+00, -8.8177e-01, 0, 0, 0, 0, 0, 0},
+	{2.1878e-04,  4.3755e-04, 2.1878e-04,
+	 1.0000e+00, -1.8674e+00, 8.8220e-01, 0, 0, 0, 0, 0}
+};
+static Bq_Cascade q6;
+static const char *numbers[] = {"3.14159", "-250", "0.001", "1200", "-.75", "99999.5"};
+static const char lcd_text[] = "\fspeed: 1234.5\vrpm\n-3.2\b\b";
+static volatile double sink;	// keeps the timed loops from being optimized out
+static volatile int isink;
+
+// allocation counts, malloc() and friends wrapped (glibc)
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t k, size_t n);
+extern void *__libc_realloc(void *p, size_t n);
+extern void __libc_free(void *p);
+static uint64_t allocs, alloc_bytes;
+
+// Functions ###################################################################
+
+void *malloc(size_t n){ allocs++; alloc_bytes += n; return __libc_malloc(n); }
+void *calloc(size_t k, size_t n){ allocs++; alloc_bytes += k*n; return __libc_calloc(k, n); }
+void *realloc(void *p, size_t n){ allocs++; alloc_bytes += n; return __libc_realloc(p, n); }
+void free(void *p){ __libc_free(p); }
+
+static double now_ns(void){
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec*1e9 + t.tv_nsec;
+}
+
+static void uart_none(const uint8_t *d, size_t n, void *ctx){}
+
+/* benchmarks ---------------------------------------------------------------*/
+static void op_cascade(int i){
+	sink = cascade(x[i & (NX-1)], lab6, 2, -10, 10);
+}
+
+static void op_bq_cascade(int i){
+	sink = bq_cascade(&q6, x[i & (NX-1)]);
+}
+
+static void op_vel(int i){
+	sink = vel();
+}
+
+static void op_printf_lcd(int i){
+	isink = printf_lcd("\fspeed: %g rpm", x[i & (NX-1)] * 1000);
+}
+
+static void op_lcd_printf(int i){
+	isink = lcd_printf("\fspeed: %g rpm", x[i & (NX-1)] * 1000);
+}
+
+static void op_putchar_lcd(int i){
+/* the escapes main-3.c translates, one character per call */
+	const char *p;
+	for (p = lcd_text; *p; p++) isink = putchar_lcd(*p);
+}
+
+static void op_lcd_puts(int i){
+	isink = lcd_puts(lcd_text);
+}
+
+static void op_sscanf(int i){
+/* the parse in double_in() */
+	double v;
+	isink = sscanf(numbers[i % 6], "%lf", &v);
+	sink = v;
+}
+
+static void op_num_parse(int i){
+	Num_Value v;
+	isink = num_parse(numbers[i % 6], &v);
+	sink = num_double(&v);
+}
+
+static void setup_getkey(int n){
+/* n presses, 20 ms down and 20 ms apart, starting now */
+	uint64_t t = sim_now() + 10*SIM_NS_PER_MS;
+	int i;
+	for (i = 0; i < n; i++) sim_keypad_press("123456789.0-"[i % 12], t + i*40*SIM_NS_PER_MS,
+			20*SIM_NS_PER_MS);
+}
+
+static void op_getkey(int i){
+/* one press, scan loop to release */
+	isink = getkey();
+}
+
+static void op_keypad_scan(int i){
+/* one scan and debounce step with no key down, the every-tick cost */
+	keypad_scan();
+}
+
+static const Bench benches[] = {
+	{"cascade", NULL, op_cascade, 0},
+	{"bq_cascade", NULL, op_bq_cascade, 0},
+	{"vel", NULL, op_vel, 0},
+	{"printf_lcd", NULL, op_printf_lcd, 0},
+	{"lcd_printf", NULL, op_lcd_printf, 0},
+	{"putchar_lcd", NULL, op_putchar_lcd, 0},
+	{"lcd_puts", NULL, op_lcd_puts, 0},
+	{"double_in sscanf", NULL, op_sscanf, 0},
+	{"num_parse", NULL, op_num_parse, 0},
+	{"getkey", setup_getkey, op_getkey, NKEYS},
+	{"keypad_scan", NULL, op_keypad_scan, 0},
+};
+#define NBENCH ((int)(sizeof(benches) / sizeof(benches[0])))
+
+/* runner -------------------------------------------------------------------*/
+static double timed(const Bench *b, int n, Result *r){
+/* n calls, fills r, returns the host ns they took */
+	uint64_t a0, b0, g0, u0;
+	double t0, t;
+	int i;
+	if (b->setup) b->setup(n);
+	a0 = allocs;
+	b0 = alloc_bytes;
+	g0 = sim_access_count();
+	u0 = sim_uart_bytes();
+	t0 = now_ns();
+	for (i = 0; i < n; i++) b->op(i);
+	t = now_ns() - t0;
+	r->ns = t / n;
+	r->ops = n / t * 1e9;
+	r->allocs = (double)(allocs - a0) / n;
+	r->bytes = (double)(alloc_bytes - b0) / n;
+	r->regs = (double)(sim_access_count() - g0) / n;
+	r->uart = (double)(sim_uart_bytes() - u0) / n;
+	return t;
+}
+
+static void run(const Bench *b, Result *r){
+	int n = 16;
+	snprintf(r->name, sizeof(r->name), "%s", b->name);
+	if (b->n){
+		timed(b, b->n, r);
+		return;
+	}
+	timed(b, n, r);		// warm up
+	while (timed(b, n, r) < MIN_NS && n < (1 << 28)) n *= 2;
+}
+
+static int load(const char *file, Result *old, int max){
+/* a CSV saved with -o */
+	FILE *fp = fopen(file, "r");
+	char line[256];
+	int n = 0;
+	if (!fp) return 0;
+	while (n < max && fgets(line, sizeof(line), fp)){
+		if (sscanf(line, "%31[^,],%lf,%lf,%lf,%lf,%lf,%lf", old[n].name, &old[n].ns, &old[n].ops,
+				&old[n].allocs, &old[n].bytes, &old[n].regs, &old[n].uart) == 7) n++;
+	}
+	fclose(fp);
+	return n;
+}
+
+int main(int argc, char **argv){
+	const char *filter = "", *out = NULL, *base = NULL;
+	static Result res[NBENCH], old[MAXB];
+	FILE *fp;
+	int i, k, nres = 0, nold = 0;
+
+	for (i = 1; i + 1 < argc; i += 2){
+		if (strcmp(argv[i], "-f") == 0) filter = argv[i+1];
+		else if (strcmp(argv[i], "-o") == 0) out = argv[i+1];
+		else if (strcmp(argv[i], "-c") == 0) base = argv[i+1];
+	}
+	if (base && (nold = load(base, old, MAXB)) == 0) printf("%s: no results\n", base);
+
+	srand(477);
+	for (i = 0; i < NX; i++) x[i] = sin(2*M_PI*i/64.0) + 0.2*((double)rand()/RAND_MAX - 0.5);
+	bq_init(&q6, lab6, 2, -10, 10);
+	sim_uart_sink(uart_none, NULL);
+	keypad_start(0);		// keypad_scan() called by the benchmark
+
+	printf("%-18s %10s %12s %9s %9s %8s %8s", "", "ns/op", "op/s", "alloc/op", "bytes/op",
+			"reg/op", "uart/op");
+	if (nold) printf(" | %10s %7s %8s %8s", "old ns/op", "new/old", "reg/op", "uart/op");
+	printf("\n");
+	for (i = 0; i < NBENCH; i++){
+		if (!strstr(benches[i].name, filter)) continue;
+		run(&benches[i], &res[nres]);
+		Result *r = &res[nres++];
+		printf("%-18s %10.1f %12.4g %9.2f %9.1f %8.1f %8.1f", r->name, r->ns, r->ops, r->allocs,
+				r->bytes, r->regs, r->uart);
+		for (k = 0; k < nold && strcmp(old[k].name, r->name) != 0; k++){}
+		if (k < nold){
+			printf(" | %10.1f %7.2f %8.1f %8.1f", old[k].ns, r->ns / old[k].ns, old[k].regs,
+					old[k].uart);
+		}
+		printf("\n");
+	}
+	keypad_stop();
+
+	if (out){
+		fp = fopen(out, "w");
+		if (!fp){
+			printf("can't open %s\n", out);
+			return 1;
+		}
+		fprintf(fp, "name,ns_op,op_s,alloc_op,bytes_op,reg_op,uart_op\n");
+		for (i = 0; i < nres; i++){
+			fprintf(fp, "%s,%.3f,%.6g,%.4f,%.2f,%.2f,%.2f\n", res[i].name, res[i].ns, res[i].ops,
+					res[i].allocs, res[i].bytes, res[i].regs, res[i].uart);
+		}
+		fclose(fp);
+	}
+	return 0;
+}
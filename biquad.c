@@ -0,0 +1,221 @@
+/*
+ * biquad.c
+ * Author: Trenton
+ * Date: 05/23/25
+ * Description: Biquad cascade filters, see biquad.h.
+ *
+ * Transposed direct form II, per section with a0 = 1:
+ * 	y  = b0*x + s1
+ * 	s1 = b1*x - a1*y + s2
+ * 	s2 = b2*x - a2*y
+ * bq_init() turns the x1, x2, y1, y2 history in each struct biquad into
+ * s1, s2, so switching a running filter over from cascade() is seamless.
+ *
+ * bq_multi_run() is the same recurrence with a vector of channels in place
+ * of each scalar. The rows in Bq_Multi are padded to BQ_MULTI_MAX, so the
+ * last vector step can run past nch without a scalar tail. Rows are moved
+ * in and out of vector variables with memcpy(), which compiles to plain
+ * (unaligned) vector loads and stores.
+ */
+
+/* includes */
+#include <string.h>
+#include "biquad.h"
+
+#if defined(__GNUC__) && !defined(BQ_SCALAR)
+typedef double Bq_Vec __attribute__((vector_size(BQ_LANES * sizeof(double))));
+#endif
+
+// Functions ###################################################################
+
+double cascade(double xin, struct biquad *fa, int ns, double ymin, double ymax){
+/*
+ * Cascade() takes an input value, saturation values,
+ * 	an array of biquad structures, and the number of biquads in the array.
+ * xin is the measured analog voltage from the C connector
+ * A difference equation is computed for each biquad, with the outputs
+ * 	of the previous biquad passing to the next, and so on.
+ * A calculated y0 is returned from the function.
+ */
+	struct biquad *f = fa; 	// f, pointer to biquad struct
+	double y0 = xin; 		// initial input voltage
+
+	// loop through ns biquads
+	int i;
+	for (i=0; i < ns; i++){
+		// assign previous output to current input
+		f->x0 = y0;
+
+		// difference equation
+		y0 = ((f->b0 * f->x0)+(f->b1 * f->x1)+(f->b2 * f->x2)-(f->a1 * f->y1)-(f->a2 * f->y2)) / (f->a0);
+
+		// update previous values of x and y
+		f->x2 = f->x1; f->x1 = f->x0;
+		f->y2 = f->y1; f->y1 = y0;
+
+		// increment pointer to next biquad struct in array
+		f++;
+	}
+
+	y0 = SATURATE(y0, ymin, ymax); 	// saturate final y0
+	return y0;						// return final output value
+}
+
+int bq_init(Bq_Cascade *q, const struct biquad *fa, int ns, double ymin, double ymax){
+/* returns -1 if there are too many sections or an a0 is 0 */
+	int i;
+	double *c;
+	if (ns < 0 || ns > BQ_MAX_SECTIONS) return -1;
+	for (i = 0; i < ns; i++){
+		if (fa[i].a0 == 0) return -1;
+	}
+	q->ns = ns;
+	q->ymin = ymin;
+	q->ymax = ymax;
+	for (i = 0; i < ns; i++){
+		bq_set(q, i, &fa[i]);
+		c = q->c[i];
+		q->s[i][0] = c[1]*fa[i].x1 + c[2]*fa[i].x2 - c[3]*fa[i].y1 - c[4]*fa[i].y2;
+		q->s[i][1] = c[2]*fa[i].x1 - c[4]*fa[i].y1;
+	}
+	return 0;
+}
+
+void bq_set(Bq_Cascade *q, int i, const struct biquad *f){
+/* the divisions by a0 happen here, once per change instead of every sample */
+	q->c[i][0] = f->b0 / f->a0;
+	q->c[i][1] = f->b1 / f->a0;
+	q->c[i][2] = f->b2 / f->a0;
+	q->c[i][3] = f->a1 / f->a0;
+	q->c[i][4] = f->a2 / f->a0;
+}
+
+int bq_retune(Bq_Cascade *q, int i, const struct biquad *f, double x1, double x2){
+/* x1, x2 are the last two inputs to section i, x1 the newest. The state
+ * after an input x is s1 = b1*x + b2*x1 - a1*y - a2*y1, s2 = b2*x - a2*y,
+ * so a new numerator only moves it by the b differences times the inputs.
+ * Returns -1 if a0 is 0 or the denominator isn't the one in use. */
+	double *c = q->c[i], b0, b1, b2;
+	if (f->a0 == 0 || f->a1 / f->a0 != c[3] || f->a2 / f->a0 != c[4]) return -1;
+	b0 = f->b0 / f->a0;
+	b1 = f->b1 / f->a0;
+	b2 = f->b2 / f->a0;
+	q->s[i][0] += (b1 - c[1])*x1 + (b2 - c[2])*x2;
+	q->s[i][1] += (b2 - c[2])*x1;
+	c[0] = b0;
+	c[1] = b1;
+	c[2] = b2;
+	return 0;
+}
+
+void bq_reset(Bq_Cascade *q){
+	int i;
+	for (i = 0; i < q->ns; i++){
+		q->s[i][0] = 0;
+		q->s[i][1] = 0;
+	}
+}
+
+double bq_cascade(Bq_Cascade *q, double xin){
+	double x = xin, y;
+	double *c, *s;
+	int i;
+	for (i = 0; i < q->ns; i++){
+		c = q->c[i];
+		s = q->s[i];
+		y = c[0]*x + s[0];
+		s[0] = c[1]*x - c[3]*y + s[1];
+		s[1] = c[2]*x - c[4]*y;
+		x = y;
+	}
+	return SATURATE(x, q->ymin, q->ymax);
+}
+
+int bq_multi_init(Bq_Multi *q, int nch, int ns, double ymin, double ymax){
+/* returns -1 if there are too many channels or sections */
+	int i, ch;
+	if (nch < 0 || nch > BQ_MULTI_MAX || ns < 0 || ns > BQ_MAX_SECTIONS) return -1;
+	memset(q, 0, sizeof(*q));
+	q->nch = nch;
+	q->ns = ns;
+	q->ymin = ymin;
+	q->ymax = ymax;
+	for (i = 0; i < ns; i++){
+		for (ch = 0; ch < BQ_MULTI_MAX; ch++) q->c[i][0][ch] = 1;	// pass-through
+	}
+	return 0;
+}
+
+int bq_multi_set(Bq_Multi *q, int ch, const struct biquad *fa, int ns){
+/* returns -1 if ch or ns is out of range or an a0 is 0 */
+	int i, k;
+	if (ch < 0 || ch >= q->nch || ns < 0 || ns > q->ns) return -1;
+	for (i = 0; i < ns; i++){
+		if (fa[i].a0 == 0) return -1;
+	}
+	for (i = 0; i < q->ns; i++){
+		if (i < ns){
+			q->c[i][0][ch] = fa[i].b0 / fa[i].a0;
+			q->c[i][1][ch] = fa[i].b1 / fa[i].a0;
+			q->c[i][2][ch] = fa[i].b2 / fa[i].a0;
+			q->c[i][3][ch] = fa[i].a1 / fa[i].a0;
+			q->c[i][4][ch] = fa[i].a2 / fa[i].a0;
+		}
+		else {
+			q->c[i][0][ch] = 1;
+			for (k = 1; k < 5; k++) q->c[i][k][ch] = 0;
+		}
+		q->s[i][0][ch] = 0;
+		q->s[i][1][ch] = 0;
+	}
+	return 0;
+}
+
+#if defined(__GNUC__) && !defined(BQ_SCALAR)
+
+void bq_multi_run(Bq_Multi *q){
+	Bq_Vec x, y, s0, s1, c0, c1, c2, c3, c4;
+	int i, ch;
+	for (ch = 0; ch < q->nch; ch += BQ_LANES){
+		memcpy(&x, &q->x[ch], sizeof(x));
+		for (i = 0; i < q->ns; i++){
+			memcpy(&c0, &q->c[i][0][ch], sizeof(x));
+			memcpy(&c1, &q->c[i][1][ch], sizeof(x));
+			memcpy(&c2, &q->c[i][2][ch], sizeof(x));
+			memcpy(&c3, &q->c[i][3][ch], sizeof(x));
+			memcpy(&c4, &q->c[i][4][ch], sizeof(x));
+			memcpy(&s0, &q->s[i][0][ch], sizeof(x));
+			memcpy(&s1, &q->s[i][1][ch], sizeof(x));
+			y = c0*x + s0;
+			s0 = c1*x - c3*y + s1;
+			s1 = c2*x - c4*y;
+			memcpy(&q->s[i][0][ch], &s0, sizeof(x));
+			memcpy(&q->s[i][1][ch], &s1, sizeof(x));
+			x = y;
+		}
+		memcpy(&q->y[ch], &x, sizeof(x));
+	}
+	for (ch = 0; ch < q->nch; ch++) q->y[ch] = SATURATE(q->y[ch], q->ymin, q->ymax);
+}
+
+#else
+
+void bq_multi_run(Bq_Multi *q){
+/* scalar version, one channel at a time like bq_cascade() */
+	double x, y, *s0, *s1;
+	int i, ch;
+	for (ch = 0; ch < q->nch; ch++){
+		x = q->x[ch];
+		for (i = 0; i < q->ns; i++){
+			s0 = &q->s[i][0][ch];
+			s1 = &q->s[i][1][ch];
+			y = q->c[i][0][ch]*x + *s0;
+			*s0 = q->c[i][1][ch]*x - q->c[i][3][ch]*y + *s1;
+			*s1 = q->c[i][2][ch]*x - q->c[i][4][ch]*y;
+			x = y;
+		}
+		q->y[ch] = SATURATE(x, q->ymin, q->ymax);
+	}
+}
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * biquad.h
+ * Author: Trenton
+ * Date: 05/23/25
+ * Description: Biquad cascade filters.
+ * cascade() is the direct form I cascade from Lab 6, it works straight on
+ * an array of struct biquad and divides by a0 every section, every sample.
+ *
+ * Bq_Cascade is the same filter set up once: bq_init() copies the
+ * sections, divides every coefficient by a0, and after that bq_cascade()
+ * runs transposed direct form II on two state values per section. The
+ * coefficients and the state are kept in their own contiguous arrays and
+ * the output is clipped with SATURATE, exactly like cascade().
+ * bq_set() keeps the state as it is, so the next output mixes old and new
+ * coefficients. bq_retune() changes only the numerator (b0 b1 b2) and
+ * corrects the state with the section's last two inputs, so from the next
+ * sample on the section runs as if it always had the new numerator on the
+ * inputs it has already seen. Its earlier outputs stay as they were, like
+ * cascade() does when the coefficients in struct biquad are changed: a
+ * PI's integrator carries over and only the new increments use the new
+ * gains.
+ *
+ * Bq_Multi runs up to BQ_MULTI_MAX channels of the same kind of cascade,
+ * each with its own coefficients. Every coefficient and state value is
+ * stored as a row over the channels (structure of arrays), so one step of
+ * the difference equation is done for BQ_LANES channels at a time with
+ * GCC vector types. BQ_LANES follows the widest double vector the target
+ * has; wider than that, GCC splits the vectors and spills them to the stack
+ * and it runs slower than the scalar loop. Build with -DBQ_SCALAR for the
+ * plain loop version. A channel with fewer sections than the
+ * others gets pass-through sections (b0 = 1) for the rest.
+ *
+ * For a filter whose coefficients never change, BQ_FIXED_CASCADE() makes a
+ * static inline function for exactly that filter: the section count is a
+ * constant, the sections are written out one after the other instead of
+ * looped over, and the coefficients come from a static const array made
+ * with BQ_SECTION(), which divides by a0 at compile time. The compiler
+ * folds them into the code, so a sample costs the multiply-adds and the
+ * saturation and nothing else. The state is a plain double[ns][2] owned
+ * by the caller. Coefficients that change at run time (the Lab 7 PI) stay
+ * with Bq_Cascade.
+ *
+ * 	static const double lab6_c[2][5] = {
+ * 		BQ_SECTION(1.0000e+00, 9.9999e-01, 0, 1, -8.8177e-01, 0),
+ * 		BQ_SECTION(2.1878e-04, 4.3755e-04, 2.1878e-04, 1, -1.8674e+00, 8.8220e-01)
+ * 	};
+ * 	BQ_FIXED_CASCADE(lab6_filter, lab6_c, 2, -10, 10)
+ * 	...
+ * 	static double s[2][2];
+ * 	v_out = lab6_filter(s, v_in);
+ */
+
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+// saturation macro for cascade(), provided by book
+#ifndef SATURATE
+#define SATURATE(x,lo,hi) ((x) < (lo) ? (lo) : (x) > (hi) ? (hi) : (x))
+#endif
+
+#define BQ_MAX_SECTIONS 8	// sections in one Bq_Cascade
+
+/* biquad structure for cascade()*/
+struct biquad {
+  double b0; double b1; double b2;   // numerator
+  double a0; double a1; double a2;   // denominator
+  double x0; double x1; double x2;   // input
+  double y1; double y2;              // output
+};
+
+/* biquad cascade implementation */
+double cascade(double xin,         // input
+               struct biquad *fa,  // biquad array
+               int    ns,          // no. segments
+               double ymin,        // min output
+               double ymax);       // max output
+
+/* normalized transposed direct form II cascade */
+typedef struct {
+	int ns;							// sections in use
+	double ymin, ymax;				// output saturation
+	double c[BQ_MAX_SECTIONS][5];	// b0 b1 b2 a1 a2, divided by a0
+	double s[BQ_MAX_SECTIONS][2];	// state
+} Bq_Cascade;
+
+int bq_init(Bq_Cascade *q, const struct biquad *fa, int ns, double ymin, double ymax);
+void bq_set(Bq_Cascade *q, int i, const struct biquad *f);	// new coefficients, state kept
+int bq_retune(Bq_Cascade *q, int i, const struct biquad *f, double x1, double x2);	// new b, no bump
+void bq_reset(Bq_Cascade *q);		// zero the state
+double bq_cascade(Bq_Cascade *q, double xin);	// one sample, same result as cascade()
+
+/* one section of constant coefficients, normalized to a0 = 1 */
+#define BQ_SECTION(b0,b1,b2,a0,a1,a2) \
+	{(b0)/(a0), (b1)/(a0), (b2)/(a0), (a1)/(a0), (a2)/(a0)}
+
+/* one TDF-II section with a0 = 1, c = b0 b1 b2 a1 a2 */
+static inline double bq_step(const double *c, double *s, double x){
+	double y = c[0]*x + s[0];
+	s[0] = c[1]*x - c[3]*y + s[1];
+	s[1] = c[2]*x - c[4]*y;
+	return y;
+}
+
+/* the sections of a fixed cascade, written out */
+#define BQ_UNROLL_1(c,s,x) x = bq_step(c[0], s[0], x)
+#define BQ_UNROLL_2(c,s,x) BQ_UNROLL_1(c,s,x); x = bq_step(c[1], s[1], x)
+#define BQ_UNROLL_3(c,s,x) BQ_UNROLL_2(c,s,x); x = bq_step(c[2], s[2], x)
+#define BQ_UNROLL_4(c,s,x) BQ_UNROLL_3(c,s,x); x = bq_step(c[3], s[3], x)
+#define BQ_UNROLL_5(c,s,x) BQ_UNROLL_4(c,s,x); x = bq_step(c[4], s[4], x)
+#define BQ_UNROLL_6(c,s,x) BQ_UNROLL_5(c,s,x); x = bq_step(c[5], s[5], x)
+#define BQ_UNROLL_7(c,s,x) BQ_UNROLL_6(c,s,x); x = bq_step(c[6], s[6], x)
+#define BQ_UNROLL_8(c,s,x) BQ_UNROLL_7(c,s,x); x = bq_step(c[7], s[7], x)
+
+/* double name(double s[ns][2], double x) running the constant sections
+ * in coef[ns][5], ns is a literal from 1 to BQ_MAX_SECTIONS */
+#define BQ_FIXED_CASCADE(name, coef, ns, ymin, ymax) \
+static inline double name(double s[ns][2], double x){ \
+	BQ_UNROLL_##ns(coef, s, x); \
+	return SATURATE(x, (ymin), (ymax)); \
+}
+
+#ifndef BQ_LANES			// channels per vector step, doubles in one register
+#if defined(__AVX512F__)
+#define BQ_LANES 8
+#elif defined(__AVX__)
+#define BQ_LANES 4
+#else
+#define BQ_LANES 2			// SSE2, and a pair of VFP registers on the myRIO
+#endif
+#endif
+#define BQ_MULTI_MAX 16		// channels in one Bq_Multi, a multiple of BQ_LANES
+#if BQ_MULTI_MAX % BQ_LANES != 0
+#error "BQ_MULTI_MAX must be a multiple of BQ_LANES"
+#endif
+
+/* several channels, one sample each per call */
+typedef struct {
+	int nch;							// channels in use
+	int ns;								// sections per channel
+	double ymin, ymax;					// output saturation
+	double c[BQ_MAX_SECTIONS][5][BQ_MULTI_MAX];	// b0 b1 b2 a1 a2 per channel
+	double s[BQ_MAX_SECTIONS][2][BQ_MULTI_MAX];	// state per channel
+	double x[BQ_MULTI_MAX];				// inputs, set before bq_multi_run()
+	double y[BQ_MULTI_MAX];				// outputs, set by bq_multi_run()
+} Bq_Multi;
+
+int bq_multi_init(Bq_Multi *q, int nch, int ns, double ymin, double ymax);	// all pass-through
+int bq_multi_set(Bq_Multi *q, int ch, const struct biquad *fa, int ns);	// channel ch, zero state
+void bq_multi_run(Bq_Multi *q);		// x[] -> y[] for every channel
+
+#endif
@@ -0,0 +1,101 @@
+/*
+ * capread.c
+ * Author: Trenton
+ * Date: 06/27/25
+ * Description: Capture file reader, see capread.h.
+ * The row count comes from the blocks themselves: every complete block
+ * but the last is full, the last one holds its own count. A block cut
+ * short by a run that died is left out.
+ */
+
+/* includes */
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "capread.h"
+
+// Functions ###################################################################
+
+int cap_map(Cap_File *f, const char *file){
+	struct stat st;
+	uint32_t head[4], rows;
+	size_t nblock;
+	int fd, i;
+	memset(f, 0, sizeof(*f));
+	fd = open(file, O_RDONLY);
+	if (fd < 0) return -1;
+	if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(head)){
+		close(fd);
+		return -1;
+	}
+	f->size = st.st_size;
+	f->map = mmap(NULL, f->size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);		// the mapping stays
+	if (f->map == MAP_FAILED){
+		f->map = NULL;
+		return -1;
+	}
+	memcpy(head, f->map, sizeof(head));
+	f->ncol = head[1];
+	f->block_rows = head[2];
+	f->block_bytes = head[3];
+	f->first = sizeof(head) + f->ncol * sizeof(Cap_Col);
+	if (memcmp(f->map, "CAP1", 4) != 0 || f->ncol < 1 || f->ncol > CAP_MAXCOL
+			|| f->block_rows == 0 || f->first > f->size){
+		cap_unmap(f);
+		return -1;
+	}
+	f->col = (const Cap_Col*)(f->map + sizeof(head));
+	f->off[0] = 8;
+	for (i = 1; i < f->ncol; i++) f->off[i] = f->off[i-1] + f->block_rows * f->col[i-1].width;
+	if (f->off[f->ncol-1] + f->block_rows * f->col[f->ncol-1].width != f->block_bytes){
+		cap_unmap(f);
+		return -1;
+	}
+	nblock = (f->size - f->first) / f->block_bytes;
+	if (nblock > 0){
+		memcpy(&rows, f->map + f->first + (nblock - 1) * f->block_bytes, 4);
+		if (rows > f->block_rows) rows = f->block_rows;
+		f->rows = (uint64_t)(nblock - 1) * f->block_rows + rows;
+	}
+	madvise((void*)f->map, f->size, MADV_SEQUENTIAL);
+	return 0;
+}
+
+void cap_unmap(Cap_File *f){
+	if (f->map) munmap((void*)f->map, f->size);
+	f->map = NULL;
+}
+
+int cap_find(const Cap_File *f, const char *name){
+	int i;
+	for (i = 0; i < f->ncol; i++){
+		if (strncmp(f->col[i].name, name, CAP_NAME) == 0) return i;
+	}
+	return -1;
+}
+
+Cap_View cap_view(const Cap_File *f, int col){
+	Cap_View v;
+	v.base = f->map + f->first + f->off[col];
+	v.stride = f->block_bytes;
+	v.block_rows = f->block_rows;
+	v.rows = f->rows;
+	v.type = f->col[col].type;
+	v.width = f->col[col].width;
+	return v;
+}
+
+const void* cap_run(const Cap_View *v, uint64_t i, uint32_t *n){
+/* row i to the end of its block, or to the last row */
+	uint32_t k = i % v->block_rows;
+	uint64_t left = v->rows - i;
+	if (i >= v->rows){
+		*n = 0;
+		return NULL;
+	}
+	*n = v->block_rows - k;
+	if (*n > left) *n = (uint32_t)left;
+	return v->base + (i / v->block_rows) * v->stride + (size_t)k * v->width;
+}
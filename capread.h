@@ -0,0 +1,68 @@
+/*
+ * capread.h
+ * Author: Trenton
+ * Date: 06/27/25
+ * Description: Capture file reader for the host, see capture.h for the
+ * layout. cap_map() maps the whole file read only and checks the header;
+ * nothing is copied. A column is read through a Cap_View, which only
+ * knows where the column starts in the first block and how far apart the
+ * blocks are: cap_get() reads one value, cap_run() gives a pointer to the
+ * values of row i up to the end of its block, so a loop over the runs
+ * goes through a column with no copies at all.
+ */
+
+#ifndef CAPREAD_H
+#define CAPREAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "capture.h"
+
+/* one column, in place */
+typedef struct {
+	const uint8_t *base;		// the column in the first block
+	size_t stride;				// block_bytes
+	uint32_t block_rows;
+	uint64_t rows;				// values in the column
+	uint32_t type, width;
+} Cap_View;
+
+typedef struct {
+	const uint8_t *map;			// the file
+	size_t size;
+	int ncol;
+	const Cap_Col *col;			// schema, in the map
+	uint32_t block_rows;
+	uint32_t block_bytes;
+	size_t first;				// offset of the first block
+	uint64_t rows;				// rows in the complete blocks
+	uint32_t off[CAP_MAXCOL];	// column offsets in a block
+} Cap_File;
+
+int cap_map(Cap_File *f, const char *file);		// 0, or -1 if not a capture file
+void cap_unmap(Cap_File *f);
+int cap_find(const Cap_File *f, const char *name);	// column index, or -1
+Cap_View cap_view(const Cap_File *f, int col);
+const void* cap_run(const Cap_View *v, uint64_t i, uint32_t *n);	// n values from row i
+
+static inline double cap_get(const Cap_View *v, uint64_t i){
+/* row i as a double, t in seconds */
+	const uint8_t *p = v->base + (i / v->block_rows) * v->stride
+			+ (i % v->block_rows) * v->width;
+	double d;
+	float f;
+	uint64_t t;
+	if (v->type == CAP_F32){
+		memcpy(&f, p, 4);
+		return f;
+	}
+	if (v->type == CAP_U64){
+		memcpy(&t, p, 8);
+		return t * 1e-9;
+	}
+	memcpy(&d, p, 8);
+	return d;
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * capture.c
+ * Author: Trenton
+ * Date: 06/27/25
+ * Description: Columnar capture file writer, see capture.h.
+ * The current block is built in memory in its file layout: a row goes
+ * into each column at its row index, and a full block is written with one
+ * write(). The unused end of the last block's columns is written as well
+ * (zeros), which keeps every block the same size.
+ */
+
+/* includes */
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "capture.h"
+
+// Functions ###################################################################
+
+static int put(int fd, const void *p, size_t n){
+	const uint8_t *b = p;
+	ssize_t w;
+	while (n > 0){
+		w = write(fd, b, n);
+		if (w < 0) return -1;
+		b += w;
+		n -= w;
+	}
+	return 0;
+}
+
+static int put_block(Capture *c){
+	uint32_t head[2] = {c->rows, 0};
+	memcpy(c->block, head, 8);
+	if (put(c->fd, c->block, c->block_bytes) < 0) c->error = 1;
+	c->rows = 0;
+	return c->error ? -1 : 0;
+}
+
+int cap_open(Capture *c, const char *file, int nch, const char *const *names,
+		const uint32_t *types){
+	uint32_t head[4];
+	int i;
+	if (nch < 1 || nch >= CAP_MAXCOL) return -1;
+	memset(c, 0, sizeof(*c));
+	c->ncol = nch + 1;
+	strcpy(c->col[0].name, "t");
+	c->col[0].type = CAP_U64;
+	c->col[0].width = 8;
+	for (i = 0; i < nch; i++){
+		if (types[i] != CAP_F64 && types[i] != CAP_F32) return -1;
+		strncpy(c->col[i+1].name, names[i], CAP_NAME - 1);
+		c->col[i+1].type = types[i];
+		c->col[i+1].width = types[i] == CAP_F32 ? 4 : 8;
+	}
+	c->block_bytes = 8;
+	for (i = 0; i < c->ncol; i++){
+		c->off[i] = c->block_bytes;
+		c->block_bytes += CAP_ROWS * c->col[i].width;
+	}
+	c->fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (c->fd < 0) return -1;
+	memcpy(head, "CAP1", 4);
+	head[1] = c->ncol;
+	head[2] = CAP_ROWS;
+	head[3] = c->block_bytes;
+	if (put(c->fd, head, sizeof(head)) < 0
+			|| put(c->fd, c->col, c->ncol * sizeof(Cap_Col)) < 0){
+		close(c->fd);
+		return -1;
+	}
+	return 0;
+}
+
+int cap_row(Capture *c, uint64_t t, const double *v){
+	uint8_t *b = c->block;
+	float f;
+	int i;
+	if (c->error) return -1;
+	memcpy(b + c->off[0] + 8*c->rows, &t, 8);
+	for (i = 1; i < c->ncol; i++){
+		if (c->col[i].type == CAP_F32){
+			f = (float)v[i-1];
+			memcpy(b + c->off[i] + 4*c->rows, &f, 4);
+		}
+		else memcpy(b + c->off[i] + 8*c->rows, &v[i-1], 8);
+	}
+	if (++c->rows == CAP_ROWS) return put_block(c);
+	return 0;
+}
+
+int cap_close(Capture *c){
+/* the rest of each column in the last block is left from the block
+ * before, cleared here */
+	int i;
+	if (c->rows > 0){
+		for (i = 0; i < c->ncol; i++){
+			memset(c->block + c->off[i] + c->rows * c->col[i].width, 0,
+					(CAP_ROWS - c->rows) * c->col[i].width);
+		}
+		put_block(c);
+	}
+	if (close(c->fd) < 0) c->error = 1;
+	return c->error ? -1 : 0;
+}
+
+/* telemetry sink -----------------------------------------------------------*/
+static int telem_write(void *ctx, const Telem_Rec *r, int n){
+	int i;
+	for (i = 0; i < n; i++){
+		if (cap_row(ctx, r[i].t, r[i].v) < 0) return -1;
+	}
+	return 0;
+}
+
+static int telem_close_cap(void *ctx){
+	return cap_close(ctx);
+}
+
+int cap_telem(Telem *t, Capture *c){
+	return telem_start(t, c->ncol - 1, telem_write, telem_close_cap, c);
+}
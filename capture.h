@@ -0,0 +1,79 @@
+/*
+ * capture.h
+ * Author: Trenton
+ * Date: 06/27/25
+ * Description: Columnar capture files.
+ * A MAT file keeps a variable's values in one run, so a stream that has
+ * several channels either goes in as one interleaved matrix or has to be
+ * rearranged at the end. A capture file is written in blocks instead:
+ * each block holds CAP_ROWS rows, stored column by column, so the file
+ * goes out in order, one write() per block, and every column is a run of
+ * fixed width values inside each block. The file describes itself (the
+ * names and types of the columns are in the header), and a reader on the
+ * host maps it and uses the values in place (capread.h).
+ *
+ * Layout, little endian:
+ * 	header		"CAP1", uint32 ncol, uint32 block_rows, uint32 block_bytes
+ * 	schema		ncol x {char name[24], uint32 type, uint32 width}
+ * 	blocks		uint32 rows, uint32 0, then column c as block_rows values
+ * Column 0 is always "t", uint64 ns from timing_now(). Every block has
+ * room for block_rows rows, only the last one may use fewer, so column c
+ * of block k is at the same offset in every block. A block is only
+ * written when it is full or at cap_close(), and a reader ignores a
+ * partly written block at the end of the file, so a run that dies keeps
+ * everything up to its last full block.
+ *
+ * cap_telem() makes the file the sink of a telemetry stream (telem.h).
+ *
+ * The labs log to capture files rather than streaming straight into a
+ * MAT file (matstream.h): the MAT stream is one interleaved double matrix
+ * that is only valid up to its last sync, where a capture keeps every
+ * full block, stores each column as a run and lets converter values be
+ * f32. matstream.c still writes the MAT file, on the host, from a capture
+ * (tools/cap2mat.c).
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include "telem.h"
+
+#define CAP_ROWS 1024			// rows per block, multiple of 2
+#define CAP_MAXCOL 8			// columns including t
+#define CAP_NAME 24				// name bytes, zero padded
+#define CAP_BLOCK_MAX (8 + CAP_ROWS * 8 * CAP_MAXCOL)
+
+/* column types */
+#define CAP_U64 1				// the time stamps
+#define CAP_F64 2
+#define CAP_F32 3
+
+/* one schema entry as it is in the file */
+typedef struct {
+	char name[CAP_NAME];
+	uint32_t type;
+	uint32_t width;				// bytes per value
+} Cap_Col;
+
+typedef struct {
+	int fd;
+	int error;					// a write failed
+	int ncol;					// columns including t
+	Cap_Col col[CAP_MAXCOL];
+	uint32_t off[CAP_MAXCOL];	// column offsets in a block
+	uint32_t block_bytes;
+	uint32_t rows;				// rows in the current block
+	_Alignas(8) uint8_t block[CAP_BLOCK_MAX];
+} Capture;
+
+/* nch value columns, names[i] and types[i] (CAP_F64 or CAP_F32) */
+int cap_open(Capture *c, const char *file, int nch, const char *const *names,
+		const uint32_t *types);
+int cap_row(Capture *c, uint64_t t, const double *v);	// one row, 0 or -1
+int cap_close(Capture *c);		// last block out, 0 or -1
+
+/* telemetry sink, c open with the same number of channels */
+int cap_telem(Telem *t, Capture *c);
+
+#endif
@@ -0,0 +1,297 @@
+/*
+ * fmt.c
+ * Author: Trenton
+ * Date: 05/16/25
+ * Description: Small printf-style formatter, see fmt.h.
+ *
+ * Numbers are built into a small buffer on the stack and then written as
+ * one field (sign, padding, body). A double is scaled by a power of ten
+ * so the digits wanted end up left of the point, rounded to an integer
+ * with rint() (round half to even, like printf on exact halves) and the
+ * digits are taken from that integer.
+ */
+
+/* includes */
+#include <stdint.h>
+#include <math.h>
+#include "fmt.h"
+
+/* definitions */
+#define NUMBUF 48	// longest number body: 1e18 with 9 decimals, or %e
+
+/* output with the count of the full length */
+typedef struct {
+	char *d;
+	int size;
+	int n;
+} Out;
+
+/* one conversion spec */
+typedef struct {
+	int left;		// '-'
+	int zero;		// '0'
+	char plus;		// '+' or ' ' or 0
+	int alt;		// '#'
+	int width;
+	int prec;		// -1 = none
+} Spec;
+
+// exact powers of ten as doubles
+static const double p10[23] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Functions ###################################################################
+
+static void put(Out *o, char c){
+	if (o->n < o->size - 1) o->d[o->n] = c;
+	o->n++;
+}
+
+static void field(Out *o, const Spec *s, char sign, const char *body, int len, int numeric){
+/* writes sign and body padded to the field width */
+	int pad = s->width - len - (sign != 0);
+	int i;
+	if (pad < 0) pad = 0;
+	if (!s->left && !(s->zero && numeric)) for (i = 0; i < pad; i++) put(o, ' ');
+	if (sign) put(o, sign);
+	if (!s->left && s->zero && numeric) for (i = 0; i < pad; i++) put(o, '0');
+	for (i = 0; i < len; i++) put(o, body[i]);
+	if (s->left) for (i = 0; i < pad; i++) put(o, ' ');
+}
+
+static int utoa(uint64_t v, unsigned base, int mindig, char *b){
+/* digits of v into b, at least mindig of them, returns the count */
+	char t[24];
+	int n = 0, i;
+	do {
+		t[n++] = "0123456789abcdef"[v % base];
+		v /= base;
+	} while (v);
+	while (n < mindig && n < 24) t[n++] = '0';
+	for (i = 0; i < n; i++) b[i] = t[n-1-i];
+	return n;
+}
+
+static double scale10(double x, int k){
+/* x * 10^k in steps of at most 10^22, at most 15 steps for any double */
+	while (k > 22){ x *= 1e22; k -= 22; }
+	while (k < -22){ x /= 1e22; k += 22; }
+	return k >= 0 ? x * p10[k] : x / p10[-k];
+}
+
+static uint64_t sig(double ax, int P, int *e){
+/* ax > 0 rounded to P significant digits: returns the digits as an
+ * integer m, 10^(P-1) <= m < 10^P, and sets e so ax ~ m * 10^(e-P+1) */
+	uint64_t m;
+	int i, x = (int)floor(log10(ax));
+	for (i = 0; i < 3; i++){	// log10() may be off by one near powers of ten
+		m = (uint64_t)rint(scale10(ax, P - 1 - x));
+		if (m >= (uint64_t)p10[P]) x++;
+		else if (m < (uint64_t)p10[P-1]) x--;
+		else break;
+	}
+	*e = x;
+	return m;
+}
+
+static int exp_body(uint64_t m, int P, int e, int trim, int alt, char *b){
+/* d.ddd e+XX from P digits in m, trailing zeros dropped if trim */
+	char d[24];
+	int n = 0, nd, last;
+	utoa(m, 10, P, d);
+	b[n++] = d[0];
+	last = P;
+	if (trim) while (last > 1 && d[last-1] == '0') last--;
+	if (last > 1 || alt) b[n++] = '.';
+	for (nd = 1; nd < last; nd++) b[n++] = d[nd];
+	b[n++] = 'e';
+	b[n++] = e < 0 ? '-' : '+';
+	n += utoa(e < 0 ? -e : e, 10, 2, b + n);
+	return n;
+}
+
+static int fmt_e(double ax, int prec, int alt, char *b){
+	int e = 0;
+	uint64_t m = 0;
+	if (prec > FMT_MAX_SIG - 1) prec = FMT_MAX_SIG - 1;
+	if (ax > 0) m = sig(ax, prec + 1, &e);
+	return exp_body(m, prec + 1, e, 0, alt, b);
+}
+
+static int fmt_f(double ax, int prec, int alt, char *b){
+	uint64_t m, ip;
+	int n;
+	if (prec > FMT_MAX_FIXED) prec = FMT_MAX_FIXED;
+	if (ax * p10[prec] >= 1e18) return fmt_e(ax, prec, alt, b);	// too big for fixed
+	m = (uint64_t)rint(ax * p10[prec]);
+	ip = m / (uint64_t)p10[prec];
+	n = utoa(ip, 10, 1, b);
+	if (prec > 0 || alt) b[n++] = '.';
+	if (prec > 0) n += utoa(m - ip * (uint64_t)p10[prec], 10, prec, b + n);
+	return n;
+}
+
+static int fmt_g(double ax, int prec, int alt, char *b){
+/* P significant digits, fixed if -4 <= exponent < P, trailing zeros dropped */
+	char d[24];
+	int P = prec < 0 ? 6 : prec == 0 ? 1 : prec;
+	int e = 0, n = 0, i, last;
+	uint64_t m = 0;
+
+	if (P > FMT_MAX_SIG) P = FMT_MAX_SIG;
+	if (ax > 0) m = sig(ax, P, &e);
+	if (e < -4 || e >= P) return exp_body(m, P, e, !alt, alt, b);
+
+	utoa(m, 10, P, d);
+	last = P;
+	if (!alt) while (last > 0 && last > e + 1 && d[last-1] == '0') last--;
+	if (e >= 0){
+		for (i = 0; i <= e; i++) b[n++] = d[i];
+		if (last > e + 1 || alt) b[n++] = '.';
+		for (; i < last; i++) b[n++] = d[i];
+	}
+	else {
+		b[n++] = '0';
+		b[n++] = '.';
+		for (i = -1; i > e; i--) b[n++] = '0';
+		for (i = 0; i < last; i++) b[n++] = d[i];
+	}
+	return n;
+}
+
+static void fmt_float(Out *o, const Spec *s, char conv, double x){
+	char b[NUMBUF];
+	char sign = s->plus;
+	int n, prec = s->prec;
+	Spec ns = *s;
+
+	if (signbit(x)){
+		sign = '-';
+		x = -x;
+	}
+	if (isnan(x) || isinf(x)){
+		ns.zero = 0;
+		field(o, &ns, isnan(x) ? 0 : sign, isnan(x) ? "nan" : "inf", 3, 0);
+		return;
+	}
+	if (conv == 'g') n = fmt_g(x, prec, s->alt, b);
+	else if (conv == 'e') n = fmt_e(x, prec < 0 ? 6 : prec, s->alt, b);
+	else n = fmt_f(x, prec < 0 ? 6 : prec, s->alt, b);
+	field(o, s, sign, b, n, 1);
+}
+
+static void fmt_int(Out *o, const Spec *s, uint64_t v, int neg, unsigned base){
+	char b[NUMBUF];
+	Spec ns = *s;
+	int n;
+	if (s->prec == 0 && v == 0) n = 0;		// printf("%.0d", 0) prints nothing
+	else n = utoa(v, base, s->prec > 0 ? s->prec : 1, b);
+	if (s->prec >= 0) ns.zero = 0;
+	field(o, &ns, neg ? '-' : (base == 10 ? s->plus : 0), b, n, 1);
+}
+
+int fmt_vformat(char *dst, int size, const char *format, va_list args){
+	Out o = {dst, size, 0};
+	const char *f = format, *start;
+	Spec s;
+	int lng, shrt;		// count of 'l' and 'h' length modifiers
+	int64_t iv;
+	uint64_t uv;
+	const char *str;
+	int len;
+	char c;
+
+	while ((c = *f++) != '\0'){
+		if (c != '%'){
+			put(&o, c);
+			continue;
+		}
+		start = f - 1;
+		s.left = s.zero = s.alt = 0;
+		s.plus = 0;
+		s.width = 0;
+		s.prec = -1;
+		lng = shrt = 0;
+		// flags
+		for (;; f++){
+			if (*f == '-') s.left = 1;
+			else if (*f == '0') s.zero = 1;
+			else if (*f == '+') s.plus = '+';
+			else if (*f == ' '){ if (s.plus != '+') s.plus = ' '; }
+			else if (*f == '#') s.alt = 1;
+			else break;
+		}
+		// width and precision
+		if (*f == '*'){
+			s.width = va_arg(args, int);
+			if (s.width < 0){
+				s.left = 1;
+				s.width = -s.width;
+			}
+			f++;
+		}
+		else while (*f >= '0' && *f <= '9') s.width = 10*s.width + (*f++ - '0');
+		if (*f == '.'){
+			f++;
+			s.prec = 0;
+			if (*f == '*'){
+				s.prec = va_arg(args, int);
+				if (s.prec < 0) s.prec = -1;
+				f++;
+			}
+			else while (*f >= '0' && *f <= '9') s.prec = 10*s.prec + (*f++ - '0');
+		}
+		// length
+		while (*f == 'l'){ lng++; f++; }
+		while (*f == 'h'){ shrt++; f++; }
+
+		switch (c = *f++){
+		case 'd': case 'i':
+			iv = lng >= 2 ? va_arg(args, long long) : lng ? va_arg(args, long) : va_arg(args, int);
+			if (!lng && shrt) iv = shrt >= 2 ? (signed char)iv : (short)iv;	// h, hh: promoted, cut back
+			fmt_int(&o, &s, iv < 0 ? (uint64_t)0 - (uint64_t)iv : (uint64_t)iv, iv < 0, 10);
+			break;
+		case 'u': case 'x':
+			uv = lng >= 2 ? va_arg(args, unsigned long long)
+					: lng ? va_arg(args, unsigned long) : va_arg(args, unsigned);
+			if (!lng && shrt) uv = shrt >= 2 ? (unsigned char)uv : (unsigned short)uv;
+			fmt_int(&o, &s, uv, 0, c == 'x' ? 16 : 10);
+			break;
+		case 'c':
+			c = (char)va_arg(args, int);
+			s.zero = 0;
+			field(&o, &s, 0, &c, 1, 0);
+			break;
+		case 's':
+			str = va_arg(args, const char*);
+			if (!str) str = "(null)";
+			for (len = 0; str[len] && (s.prec < 0 || len < s.prec); len++){}
+			s.zero = 0;
+			field(&o, &s, 0, str, len, 0);
+			break;
+		case 'f': case 'e': case 'g':
+			fmt_float(&o, &s, c, va_arg(args, double));
+			break;
+		case '%':
+			put(&o, '%');
+			break;
+		default:	// not supported, copy the spec as written
+			if (c == '\0') f--;
+			while (start < f) put(&o, *start++);
+			break;
+		}
+	}
+	if (size > 0) dst[o.n < size ? o.n : size - 1] = '\0';
+	return o.n;
+}
+
+int fmt_format(char *dst, int size, const char *format, ...){
+	int n;
+	va_list args;
+	va_start(args, format);
+	n = fmt_vformat(dst, size, format, args);
+	va_end(args);
+	return n;
+}
@@ -0,0 +1,35 @@
+/*
+ * fmt.h
+ * Author: Trenton
+ * Date: 05/16/25
+ * Description: Small printf-style formatter for LCD output from real time
+ * threads. vsnprintf() handles every format and locale and can take a
+ * long and uneven time on a double. This one only does what the labs
+ * print, never allocates, keeps no state between calls (safe in an ISR
+ * thread), and the work for a %g or %f is a fixed number of steps.
+ *
+ * Conversions: %d %i %u %x %c %s %% %f %e %g
+ * Flags '-' '0' '+' ' ', width and precision (also '*'), length l ll h hh.
+ * Unknown conversions are copied as written.
+ *
+ * Floating point is rounded from a scaled binary value instead of the
+ * exact decimal expansion, so for a value within about one part in 10^15
+ * of a rounding boundary the last digit can differ from printf's.
+ * %f needs |value| * 10^precision < 10^18 and precision <= FMT_MAX_FIXED,
+ * larger values are printed like %e. %g and %e use up to FMT_MAX_SIG digits.
+ */
+
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdarg.h>
+
+#define FMT_MAX_FIXED 9		// most digits after the point for %f
+#define FMT_MAX_SIG 17		// most significant digits for %e and %g
+
+int fmt_vformat(char *dst, int size, const char *format, va_list args);
+int fmt_format(char *dst, int size, const char *format, ...);
+/* both return the length of the full output like vsnprintf(), at most
+ * size-1 characters are stored and dst is always '\0' terminated */
+
+#endif
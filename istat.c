@@ -0,0 +1,116 @@
+/*
+ * istat.c
+ * Author: Trenton
+ * Date: 07/04/25
+ * Description: Interrupt latency and service time statistics, see istat.h.
+ * Bucket of a value v: below ISTAT_SUB it is v itself, above it is the
+ * power of two e (the top bit) and the next 3 bits under it:
+ * 	ISTAT_SUB*(e - 2) + ((v >> (e - 3)) & 7)
+ * which gives buckets of the same width from 8 to 15, 16 to 31 in steps
+ * of 2 and so on. A percentile is reported as the top of its bucket (but
+ * never more than the max), so it is never less than the real value.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <string.h>
+#include "timing.h"
+#include "istat.h"
+
+// Functions ###################################################################
+
+static int bucket(uint64_t v){
+	int e;
+	if (v > ISTAT_MAX_NS) v = ISTAT_MAX_NS;
+	if (v < ISTAT_SUB) return (int)v;
+	e = 63 - __builtin_clzll(v);
+	return ISTAT_SUB*(e - 2) + (int)((v >> (e - 3)) & (ISTAT_SUB - 1));
+}
+
+static uint64_t bucket_low(int i){
+/* smallest value in bucket i */
+	int e = i / ISTAT_SUB + 2;
+	if (i < ISTAT_SUB) return i;
+	return (uint64_t)(ISTAT_SUB + i % ISTAT_SUB) << (e - 3);
+}
+
+static void add(Istat_Hist *h, uint64_t v){
+	h->count[bucket(v)]++;
+	h->n++;
+	if (v > h->max) h->max = v;
+}
+
+void istat_init(Istat *s, const char *name){
+	memset(&s->late, 0, sizeof(s->late));
+	memset(&s->exec, 0, sizeof(s->exec));
+	s->name = name;
+	s->t_assert = 0;
+	s->t_wake = 0;
+	s->late_ns = (uint64_t)-1;
+	atomic_init(&s->seq, 0);
+}
+
+void istat_assert(Istat *s, uint64_t t){
+	s->t_assert = t;
+}
+
+void istat_wake(Istat *s){
+	s->t_wake = timing_now();
+	s->late_ns = (uint64_t)-1;
+	if (s->t_assert){
+		// woken early (a spurious wake-up) counts as 0
+		s->late_ns = s->t_wake > s->t_assert ? s->t_wake - s->t_assert : 0;
+		s->t_assert = 0;	// used up, the ISR sets the next one
+	}
+}
+
+void istat_ack(Istat *s){
+/* both samples under one counter update, the reader sees both or neither */
+	uint64_t now = timing_now();
+	unsigned q = atomic_load_explicit(&s->seq, memory_order_relaxed);
+	atomic_store_explicit(&s->seq, q + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	if (s->late_ns != (uint64_t)-1) add(&s->late, s->late_ns);
+	add(&s->exec, now - s->t_wake);
+	atomic_store_explicit(&s->seq, q + 2, memory_order_release);
+}
+
+void istat_read(Istat *s, Istat_Hist *late, Istat_Hist *exec){
+/* a copy takes a few microseconds, much less than a timer period */
+	unsigned q;
+	do {
+		q = atomic_load_explicit(&s->seq, memory_order_acquire);
+		memcpy(late, &s->late, sizeof(*late));
+		memcpy(exec, &s->exec, sizeof(*exec));
+		atomic_thread_fence(memory_order_acquire);
+	} while ((q & 1) || atomic_load_explicit(&s->seq, memory_order_relaxed) != q);
+}
+
+uint64_t istat_percentile(const Istat_Hist *h, double p){
+	uint64_t want = (uint64_t)(p * h->n + 0.5), sum = 0, top;
+	int i;
+	if (h->n == 0) return 0;
+	if (want < 1) want = 1;
+	for (i = 0; i < ISTAT_BUCKETS; i++){
+		sum += h->count[i];
+		if (sum >= want) break;
+	}
+	top = i + 1 < ISTAT_BUCKETS ? bucket_low(i + 1) - 1 : h->max;
+	return top < h->max ? top : h->max;
+}
+
+static void print_hist(const char *name, const char *what, const Istat_Hist *h){
+	if (h->n == 0){
+		printf("%s %s: no samples\n", name, what);
+		return;
+	}
+	printf("%s %s: n %u  p50 %.1f us  p99 %.1f us  max %.1f us\n", name, what, h->n,
+			istat_percentile(h, 0.50) / 1e3, istat_percentile(h, 0.99) / 1e3, h->max / 1e3);
+}
+
+void istat_print(Istat *s){
+	Istat_Hist late, exec;
+	istat_read(s, &late, &exec);
+	print_hist(s->name, "late", &late);
+	print_hist(s->name, "exec", &exec);
+}
@@ -0,0 +1,65 @@
+/*
+ * istat.h
+ * Author: Trenton
+ * Date: 07/04/25
+ * Description: Interrupt latency and service time statistics.
+ * An ISR marks three points of every interrupt: when the IRQ is expected
+ * to assert (istat_assert(), known for the timer, which asserts a set
+ * time after it is armed), when Irq_Wait() returned with it (istat_wake())
+ * and when it is acknowledged (istat_ack()). Each interrupt adds one
+ * sample to two histograms:
+ * 	late	wake-up - assertion, how late the ISR started
+ * 	exec	acknowledge - wake-up, how long the service body took
+ * For a DI interrupt there is no assertion time to read back, so only
+ * exec is kept (late stays empty).
+ *
+ * The histograms are log bucketed, 8 buckets per power of two, so a value
+ * is known to within 12.5% from 8 ns up to ISTAT_MAX_NS, and the memory is
+ * fixed (ISTAT_BUCKETS counters each) however long the run. The largest
+ * value is also kept exactly.
+ *
+ * istat_read() copies both histograms from any thread while the ISR runs,
+ * behind a sequence counter like ptable.c: the ISR never waits, the
+ * reader retries if a sample was added during the copy. istat_print()
+ * prints p50, p99 and max of both.
+ */
+
+#ifndef ISTAT_H
+#define ISTAT_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+#define ISTAT_SUB 8					// buckets per power of two
+#define ISTAT_BUCKETS (ISTAT_SUB * 33)	// up to 2^35 ns, about 34 s
+#define ISTAT_MAX_NS ((1ULL << 35) - 1)	// larger values go in the last bucket
+
+typedef struct {
+	uint32_t count[ISTAT_BUCKETS];
+	uint32_t n;						// samples
+	uint64_t max;					// largest sample (ns)
+} Istat_Hist;
+
+typedef struct {
+	const char *name;
+	atomic_uint seq;				// odd while the ISR adds a sample
+	Istat_Hist late;				// wake-up - assertion
+	Istat_Hist exec;				// acknowledge - wake-up
+	uint64_t t_assert;				// next expected assertion, 0 if unknown
+	uint64_t t_wake;
+	uint64_t late_ns;				// this interrupt's, or -1 if unknown
+} Istat;
+
+void istat_init(Istat *s, const char *name);
+
+/* ISR thread, no locks or system calls */
+void istat_assert(Istat *s, uint64_t t);	// the next assertion is due at t
+void istat_wake(Istat *s);					// Irq_Wait() returned it
+void istat_ack(Istat *s);					// just before Irq_Acknowledge()
+
+/* any thread */
+void istat_read(Istat *s, Istat_Hist *late, Istat_Hist *exec);
+uint64_t istat_percentile(const Istat_Hist *h, double p);	// ns, upper bound
+void istat_print(Istat *s);
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * keypad.c
+ * Author: Trenton
+ * Date: 04/18/25
+ * Description: Keypad driver, see keypad.h.
+ *
+ * Scan: for each column, set the other columns to high-z and drive the
+ * column low, then read the rows. A low row is a closed key. The bank is
+ * handled as a whole (regio.c), so a column costs one direction write and
+ * one input read instead of a read or write per pin.
+ *
+ * Debounce: each key has a stable state and a counter. A raw reading that
+ * differs from the stable state has to be seen KEYPAD_DEBOUNCE scans in a
+ * row before the stable state changes and an event is queued. A reading
+ * that agrees with the stable state resets the counter.
+ *
+ * Queue: single producer (the scanner) / single consumer (the reader)
+ * ring. A semaphore counts the queued events for keypad_wait().
+ */
+
+/* includes */
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "MyRio.h"
+#include "T1.h"
+#include "timing.h"
+#include "regio.h"
+#include "lineedit.h"
+#include "keypad.h"
+
+/* definitions */
+#define QMASK (KEYPAD_QUEUE - 1)
+
+// Key Code Lookup Table, [row][column]
+static const char table[4][4] = {
+		{'1', '2', '3', UP},
+		{'4', '5', '6', DN},
+		{'7', '8', '9', ENT},
+		{'0', '.', '-', DEL}
+};
+
+static Dio_Bank bank;			// DIOB_70, columns 0-3, rows 4-7
+static int bank_init = 0;
+static uint8_t stable[16];		// debounced state, 1 = pressed
+static uint8_t count[16];		// scans the raw state has differed
+
+static Key_Event queue[KEYPAD_QUEUE];
+static atomic_uint q_head;		// written by the scanner
+static atomic_uint q_tail;		// written by the reader
+static atomic_uint dropped;
+static sem_t q_count;			// queued events
+static int q_init = 0;
+
+static pthread_t scanner;
+static atomic_int scanning;		// scan thread keep-going flag
+static uint64_t period = KEYPAD_SCAN_NS;
+
+/* prototypes */
+static void* keypad_thread(void *arg);
+static void init(void);
+static void post(int k, Key_EventType type, uint64_t t);
+
+// Functions ###################################################################
+
+static void init(void){
+/* keypad bank and queue, first use only */
+	if (!bank_init){
+		dio_bank_init(&bank, DIOB_70DIR, DIOB_70OUT, DIOB_70IN);
+		dio_bank_write(&bank, 0xFF, 0x00, 0x00);	// all high-z, columns drive low
+		bank_init = 1;
+	}
+	if (!q_init){
+		sem_init(&q_count, 0, 0);
+		q_init = 1;
+	}
+}
+
+int keypad_start(uint64_t scan_ns){
+/* scan_ns = 0: no thread, the caller runs keypad_scan() every tick */
+	init();
+	if (scan_ns == 0) return 0;
+	period = scan_ns;
+	atomic_store(&scanning, 1);
+	if (timing_thread_create(&scanner, keypad_thread, NULL) != 0){
+		atomic_store(&scanning, 0);
+		return -1;
+	}
+	return 0;
+}
+
+void keypad_stop(void){
+	if (!atomic_load(&scanning)) return;
+	atomic_store(&scanning, 0);
+	timing_join(scanner);
+}
+
+static void* keypad_thread(void *arg){
+	Tick t;
+	tick_start(&t, period);
+	while (atomic_load(&scanning)){
+		keypad_scan();
+		tick_wait(&t);
+	}
+	return NULL;
+}
+
+static void post(int k, Key_EventType type, uint64_t t){
+/* queue an event, dropped if the reader has fallen KEYPAD_QUEUE behind */
+	unsigned h = atomic_load_explicit(&q_head, memory_order_relaxed);
+	if (h - atomic_load_explicit(&q_tail, memory_order_acquire) >= KEYPAD_QUEUE){
+		atomic_fetch_add(&dropped, 1);
+		return;
+	}
+	queue[h & QMASK].key = table[k / 4][k % 4];
+	queue[h & QMASK].type = type;
+	queue[h & QMASK].time = t;
+	atomic_store_explicit(&q_head, h + 1, memory_order_release);
+	timing_sem_post(&q_count);
+}
+
+void keypad_scan(void){
+/* one pass over all 16 keys, key k is row k/4, column k%4 */
+	int c, r, k;
+	uint64_t now;
+	uint8_t rows, raw;
+
+	init();
+	now = timing_now();
+	for (c = 0; c < 4; c++){
+		dio_bank_write(&bank, 0x0F, 1 << c, 0x00);	// only column c driven (low)
+		rows = dio_bank_read(&bank) >> 4;
+		for (r = 0; r < 4; r++){
+			raw = !(rows & (1 << r));	// low = closed
+			k = 4*r + c;
+			if (raw == stable[k]){
+				count[k] = 0;
+			}
+			else if (++count[k] >= KEYPAD_DEBOUNCE){
+				stable[k] = raw;
+				count[k] = 0;
+				post(k, raw ? KEY_PRESS : KEY_RELEASE, now);
+			}
+		}
+	}
+}
+
+int keypad_poll(Key_Event *e){
+	unsigned t;
+	init();
+	if (sem_trywait(&q_count) != 0) return 0;
+	t = atomic_load_explicit(&q_tail, memory_order_relaxed);
+	*e = queue[t & QMASK];
+	atomic_store_explicit(&q_tail, t + 1, memory_order_release);
+	return 1;
+}
+
+void keypad_wait(Key_Event *e){
+	unsigned t;
+	init();
+	timing_sem_wait(&q_count);
+	t = atomic_load_explicit(&q_tail, memory_order_relaxed);
+	*e = queue[t & QMASK];
+	atomic_store_explicit(&q_tail, t + 1, memory_order_release);
+}
+
+char keypad_getkey(void){
+/* same result as the polling getkey(): the key, once it is let go */
+	Key_Event e;
+	do {
+		keypad_wait(&e);
+	} while (e.type != KEY_RELEASE);
+	return e.key;
+}
+
+char *keypad_gets(char *buffer, int bufferlen){
+/* like fgets_keypad(): echoes keys to the LCD until ENT, DEL deletes */
+	Line_Edit line;
+	line_init(&line, buffer, bufferlen, putchar_lcd);
+	while (line_key(&line, keypad_getkey()) != LINE_DONE){}
+	return buffer;
+}
+
+uint32_t keypad_dropped(void){
+	return atomic_load(&dropped);
+}
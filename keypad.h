@@ -0,0 +1,48 @@
+/*
+ * keypad.h
+ * Author: Trenton
+ * Date: 04/18/25
+ * Description: Keypad driver with debounced key events.
+ * The 4x4 keypad on connector B (columns DIOB 0-3, rows DIOB 4-7) is
+ * scanned once per tick, either by the driver's own scan thread or by
+ * calling keypad_scan() from a periodic tick the program already has.
+ * Each key has its own debounce state and press/release events go into a
+ * queue, so the reading thread isn't tied up for the whole keypress.
+ *
+ * On connector B only DIOB 0-3 have DI interrupts, and those are the
+ * column pins the scan drives. The row pins the keys pull (DIOB 4-7) have
+ * none, so a key press can't raise an IRQ by itself and the scan is
+ * always tick driven.
+ */
+
+#ifndef KEYPAD_H
+#define KEYPAD_H
+
+#include <stdint.h>
+
+#define KEYPAD_SCAN_NS 5000000ULL	// default scan period: 5 ms
+#define KEYPAD_DEBOUNCE 2			// scans a change must hold for
+#define KEYPAD_QUEUE 32				// queued events, power of 2
+
+typedef enum {
+	KEY_PRESS = 0,
+	KEY_RELEASE
+} Key_EventType;
+
+typedef struct {
+	char key;			// key code, as returned by getkey()
+	uint8_t type;		// Key_EventType
+	uint64_t time;		// timing_now() of the scan that saw it (ns)
+} Key_Event;
+
+int keypad_start(uint64_t scan_ns);	// scan thread at scan_ns, 0 = caller scans
+void keypad_stop(void);				// stop the scan thread
+void keypad_scan(void);				// one scan and debounce step
+
+int keypad_poll(Key_Event *e);		// 1 and the next event, or 0 if none
+void keypad_wait(Key_Event *e);		// block until the next event
+char keypad_getkey(void);			// block until a key is released, return it
+char *keypad_gets(char *buffer, int bufferlen);	// keys until ENT, DEL deletes
+uint32_t keypad_dropped(void);		// events lost to a full queue
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ * lcd.c
+ * Author: Trenton
+ * Date: 04/04/25
+ * Description: Shared T1 LCD output, see lcd.h.
+ * Escape sequences (same as putchar_lcd() from Lab 3):
+ * 	'\f' -> 12, 17	clear display
+ * 	'\n' -> 13		the display treats 13 as new line + return
+ * 	'\b', '\v'		sent as is
+ * Codes outside 0-255 are invalid.
+ *
+ * Screen model: cell[][] is what the callers want on the display, shown[][]
+ * is what was last sent. lcd_flush() builds two candidate updates and sends
+ * the shorter one:
+ * 	-diff: a cursor move to each changed run, then its characters
+ * 	-clear: '\f' then the non-blank cells, for when most of it changed
+ * The model only holds printable ASCII, other codes besides the escapes
+ * are dropped. Writes that bypass the model (lcd_puts, lcd_write, the T1
+ * putchar_lcd() and its keypad echo) make the shadow copy stale, lcd_puts
+ * calls lcd_invalidate() for that. A lab that mixes them with the model
+ * either sends putchar_lcd() through it too (main-1.c) or calls
+ * lcd_invalidate() after the direct writes (ptable.c).
+ * The model is shared by the ISR and main threads, so it is locked.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include "MyRio.h"
+#include "UART.h"
+#include "lcd.h"
+#include "fmt.h"
+
+/* definitions */
+static MyRio_Uart uart;		// port information structure
+static int uart_open = 0;	// UART opened flag
+
+// screen model
+static pthread_mutex_t screen_lock = PTHREAD_MUTEX_INITIALIZER;
+static char cell[LCD_ROWS][LCD_COLS];	// wanted contents
+static char shown[LCD_ROWS][LCD_COLS];	// contents last sent
+static int shown_valid = 0;			// shown[][] matches the display
+static int cur_row = 0, cur_col = 0;	// model cursor
+static int phys_row = 0, phys_col = 0;	// display cursor after last flush
+static int model_init = 0;			// cell[][] cleared flag
+
+/* prototypes */
+static int build_update(uint8_t *d, char from[LCD_ROWS][LCD_COLS], int *row, int *col);
+
+// Functions ###################################################################
+
+int lcd_open(void){
+/* opens the UART on connector B the first time it is called */
+	NiFpga_Status status;
+	if (uart_open) return 0;
+	uart.name = "ASRL2::INSTR";				// UART on connector B
+	uart.defaultRM = 0;						// define resource manager
+	uart.session = 0;						// session reference number
+	status = Uart_Open(&uart,				// port information
+						LCD_BAUD,			// baud rate, bits per second
+						8,					// number of data bits
+						Uart_StopBits1_0,	// 1 stop bit
+						Uart_ParityNone);	// no parity bit
+	if (status < VI_SUCCESS){
+		return EOF;
+	}
+	uart_open = 1;
+	return 0;
+}
+
+int lcd_translate_char(int c, uint8_t *d){
+/* writes the UART codes for c to d, returns how many (0 if c is invalid) */
+	if (c > 255 || c < 0){
+		return 0;
+	}
+	if (c == '\n'){
+		d[0] = 13;
+		return 1;
+	}
+	if (c == '\f'){
+		d[0] = 12;
+		d[1] = 17;
+		return 2;
+	}
+	d[0] = (uint8_t)c;
+	return 1;
+}
+
+int lcd_translate(const char *s, uint8_t *d, int dlen){
+/* translates s into d, stopping before a character that doesn't fit
+ * returns the number of bytes in d */
+	int i, k, n = 0;
+	uint8_t code[LCD_MAXBYTES];
+	while (*s){
+		k = lcd_translate_char((unsigned char)*s++, code);
+		if (n + k > dlen) break;
+		for (i = 0; i < k; i++) d[n++] = code[i];
+	}
+	return n;
+}
+
+int lcd_write(const uint8_t *d, int n){
+	NiFpga_Status status;
+	if (lcd_open() == EOF) return EOF;
+	if (n <= 0) return 0;
+	status = Uart_Write(&uart, d, n);
+	if (status < VI_SUCCESS){
+		return EOF;
+	}
+	return 0;
+}
+
+int lcd_puts(const char *s){
+/* one Uart_Write for a printf_lcd() sized string (80 chars), longer
+ * strings go out in 160 byte pieces
+ * This bypasses the screen model, so the next flush repaints. */
+	uint8_t d[2*80];
+	int n = 0;
+	while (*s){
+		if (n > (int)sizeof(d) - LCD_MAXBYTES){
+			if (lcd_write(d, n) == EOF) return EOF;
+			n = 0;
+		}
+		n += lcd_translate_char((unsigned char)*s++, d + n);
+	}
+	lcd_invalidate();
+	return lcd_write(d, n);
+}
+
+/* screen model ----------------------------------------------------------------*/
+static void model_putc(int c){
+/* moves the model cursor like the display does, screen_lock held */
+	if (!model_init){
+		memset(cell, ' ', sizeof(cell));
+		model_init = 1;
+	}
+	if (c == '\f'){				// clear and home
+		memset(cell, ' ', sizeof(cell));
+		cur_row = cur_col = 0;
+	}
+	else if (c == '\v'){			// home
+		cur_row = cur_col = 0;
+	}
+	else if (c == '\n'){			// next line, first column
+		cur_row = (cur_row + 1) % LCD_ROWS;
+		cur_col = 0;
+	}
+	else if (c == '\b'){			// back one
+		if (cur_col > 0){
+			cur_col--;
+		}
+		else{
+			cur_row = (cur_row + LCD_ROWS - 1) % LCD_ROWS;
+			cur_col = LCD_COLS - 1;
+		}
+	}
+	else if (c >= ' ' && c < 127){	// printable, wraps to next line
+		cell[cur_row][cur_col] = (char)c;
+		if (++cur_col == LCD_COLS){
+			cur_col = 0;
+			cur_row = (cur_row + 1) % LCD_ROWS;
+		}
+	}
+}
+
+void lcd_screen_putc(int c){
+	pthread_mutex_lock(&screen_lock);
+	model_putc(c);
+	pthread_mutex_unlock(&screen_lock);
+}
+
+void lcd_screen_puts(const char *s){
+	pthread_mutex_lock(&screen_lock);
+	while (*s) model_putc((unsigned char)*s++);
+	pthread_mutex_unlock(&screen_lock);
+}
+
+void lcd_invalidate(void){
+	pthread_mutex_lock(&screen_lock);
+	shown_valid = 0;
+	pthread_mutex_unlock(&screen_lock);
+}
+
+static int build_update(uint8_t *d, char from[LCD_ROWS][LCD_COLS], int *row, int *col){
+/* bytes that take the display from "from", with its cursor at row, col,
+ * to cell[][], screen_lock held
+ * A changed cell gets a cursor move unless the cursor is already there
+ * from the previous character. row, col are left where the display
+ * cursor ends up. */
+	int r, c, n = 0;
+	for (r = 0; r < LCD_ROWS; r++){
+		for (c = 0; c < LCD_COLS; c++){
+			if (cell[r][c] == from[r][c]) continue;
+			if (r != *row || c != *col){
+				d[n++] = (uint8_t)(LCD_MOVE + LCD_COLS*r + c);
+			}
+			d[n++] = (uint8_t)cell[r][c];
+			*row = r;
+			*col = c + 1;
+			if (*col == LCD_COLS){	// display wraps to the next line
+				*col = 0;
+				*row = (r + 1) % LCD_ROWS;
+			}
+		}
+	}
+	return n;
+}
+
+int lcd_flush(void){
+/* sends the changed cells in one Uart_Write */
+	static char blank[LCD_ROWS][LCD_COLS];
+	uint8_t diff[2*LCD_ROWS*LCD_COLS];		// move + char per cell at most
+	uint8_t clear[2 + 2*LCD_ROWS*LCD_COLS];
+	int ndiff = -1, nclear;
+	int diff_row = phys_row, diff_col = phys_col;	// cursor after each update
+	int clear_row = 0, clear_col = 0;
+	int status;
+
+	pthread_mutex_lock(&screen_lock);
+	if (!model_init) model_putc('\f');
+	memset(blank, ' ', sizeof(blank));
+	// clear then repaint, always possible
+	clear[0] = 12;
+	clear[1] = 17;
+	nclear = 2 + build_update(clear + 2, blank, &clear_row, &clear_col);
+	// only the changed cells, if we know what is on the display
+	if (shown_valid){
+		ndiff = build_update(diff, shown, &diff_row, &diff_col);
+	}
+	if (ndiff >= 0 && ndiff <= nclear){
+		status = lcd_write(diff, ndiff);
+		phys_row = diff_row;
+		phys_col = diff_col;
+	}
+	else{
+		status = lcd_write(clear, nclear);
+		phys_row = clear_row;
+		phys_col = clear_col;
+	}
+	memcpy(shown, cell, sizeof(shown));
+	shown_valid = (status != EOF);
+	pthread_mutex_unlock(&screen_lock);
+	return status;
+}
+
+int lcd_printf(const char *format, ...){
+/* same buffer and return value as printf_lcd(), but formatted by fmt.c
+ * so a %g costs the same every call */
+	int n;
+	char string[80];
+	va_list args;
+	va_start(args, format);
+	n = fmt_vformat(string, 80, format, args);
+	va_end(args);
+	if (n <= 0) return -1;
+	lcd_screen_puts(string);
+	if (lcd_flush() == EOF) return -1;
+	return n;
+}
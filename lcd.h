@@ -0,0 +1,40 @@
+/*
+ * lcd.h
+ * Author: Trenton
+ * Date: 04/04/25
+ * Description: Shared T1 LCD output over the connector B UART.
+ * Holds the one UART session and the escape translation used by
+ * putchar_lcd(), so printf_lcd() can translate a whole string into one
+ * buffer and send it with a single Uart_Write.
+ *
+ * The screen model keeps a shadow copy of the 4x20 display. Callers write
+ * into the model (same escapes as putchar_lcd) and lcd_flush() sends only
+ * the cursor moves and characters for cells that changed since the last
+ * flush, so repainting "\fspeed: %g rpm" only sends the digits that moved.
+ */
+
+#ifndef LCD_H
+#define LCD_H
+
+#include <stdint.h>
+
+#define LCD_BAUD 19200		// T1 target display baud rate
+#define LCD_MAXBYTES 2		// most UART bytes for one character ('\f')
+#define LCD_ROWS 4			// display lines
+#define LCD_COLS 20			// characters per line
+#define LCD_MOVE 128		// cursor to row r, col c: 128 + 20*r + c
+
+int lcd_open(void);		// opens the UART on first call, 0 or EOF
+int lcd_translate_char(int c, uint8_t *d);	// bytes for one character, 0 if invalid
+int lcd_translate(const char *s, uint8_t *d, int dlen);	// bytes for a string
+int lcd_write(const uint8_t *d, int n);		// one Uart_Write, 0 or EOF
+int lcd_puts(const char *s);	// translate and send in one write, 0 or EOF
+
+/* screen model */
+void lcd_screen_putc(int c);		// write c into the model, no output
+void lcd_screen_puts(const char *s);	// write s into the model, no output
+int lcd_flush(void);		// send changed cells in one write, 0 or EOF
+int lcd_printf(const char *format, ...);	// printf_lcd() with fmt.c, length or -1
+void lcd_invalidate(void);	// display contents unknown, next flush repaints
+
+#endif
@@ -0,0 +1,212 @@
+/*
+ * lcd_async.c
+ * Author: Trenton
+ * Date: 04/11/25
+ * Description: Asynchronous LCD writer, see lcd_async.h.
+ *
+ * Ring: head is written only by the producer, tail by the consumer, both
+ * count up forever and are masked into buf[]. Each message is a length
+ * byte followed by its characters, and head and tail only ever move by
+ * whole messages. For LCD_DROP_OLDEST the producer makes room by moving
+ * tail past the oldest messages with a compare-and-swap, so a message is
+ * never cut (a "\f" can't be lost from the front of one). The consumer
+ * copies a message out and then claims it with a compare-and-swap on
+ * tail. If that fails the producer took the message back (and may have
+ * written over it), so the copy is thrown away and read again.
+ *
+ * Pushes from two threads (the ISR and the main loop) don't wait for each
+ * other either: a flag marks a push in progress, and a push that finds it
+ * set drops its message and counts it. A push is a copy of at most
+ * LCD_ASYNC_MSG bytes, so that only happens when one thread preempts the
+ * other in that copy.
+ *
+ * The writer is woken with a semaphore, sem_post() doesn't block so it is
+ * safe in the ISR thread. The waits go through timing.c so the host
+ * simulation runs the writer at the virtual time of the post.
+ *
+ * If the writer can't be started, the output calls write to the screen
+ * model and flush themselves, one message at a time under a lock, so the
+ * caller waits on the UART as it did before, and lcd_async_stop() has
+ * nothing to do.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "lcd.h"
+#include "lcd_async.h"
+#include "fmt.h"
+#include "timing.h"
+
+/* definitions */
+#define MASK (LCD_ASYNC_SIZE - 1)
+
+static uint8_t buf[LCD_ASYNC_SIZE];
+static atomic_uint head;		// next message to write (producer)
+static atomic_uint tail;		// next message to read (consumer)
+static atomic_uint dropped;		// messages dropped
+static atomic_uint dropped_bytes;	// characters in the messages dropped
+static atomic_uint queued;		// messages accepted
+static atomic_int running;		// writer thread keep-going flag
+static atomic_flag pushing = ATOMIC_FLAG_INIT;	// a producer is in push()
+static pthread_mutex_t now_lock = PTHREAD_MUTEX_INITIALIZER;	// write_now()
+static Lcd_Overflow overflow;	// overflow policy
+static sem_t wake;				// data available
+static pthread_t writer;
+static int started = 0;			// writer running, set before any producer runs
+
+/* prototypes */
+static void* lcd_writer(void *arg);
+static int push(const uint8_t *d, unsigned n);
+
+// Functions ###################################################################
+
+int lcd_async_start(Lcd_Overflow policy){
+/* starts the writer thread at the lowest priority the system allows */
+	atomic_store(&head, 0);
+	atomic_store(&tail, 0);
+	atomic_store(&dropped, 0);
+	atomic_store(&dropped_bytes, 0);
+	atomic_store(&queued, 0);
+	atomic_store(&running, 1);
+	overflow = policy;
+	started = 0;
+	if (lcd_open() == EOF) return -1;
+	if (sem_init(&wake, 0, 0) != 0) return -1;
+	if (timing_thread_create(&writer, lcd_writer, NULL) != 0){
+		sem_destroy(&wake);
+		return -1;
+	}
+	started = 1;
+#ifdef SCHED_IDLE
+	{
+		struct sched_param sp = {0};
+		pthread_setschedparam(writer, SCHED_IDLE, &sp);	// best effort
+	}
+#endif
+	return 0;
+}
+
+void lcd_async_stop(void){
+	if (!started) return;
+	atomic_store(&running, 0);
+	timing_sem_post(&wake);
+	timing_join(writer);
+	sem_destroy(&wake);
+	started = 0;
+}
+
+static int write_now(const uint8_t *d, unsigned n){
+/* no writer: into the screen model and out, the caller waits */
+	unsigned i;
+	int status;
+	pthread_mutex_lock(&now_lock);
+	for (i = 0; i < n; i++) lcd_screen_putc(d[i]);
+	status = lcd_flush();
+	pthread_mutex_unlock(&now_lock);
+	return status;
+}
+
+static int push(const uint8_t *d, unsigned n){
+/* copies n bytes into the ring as one message, returns 0 or EOF */
+	unsigned h, t, i;
+
+	if (!started) return write_now(d, n);
+	if (n == 0) return 0;
+	if (n > LCD_ASYNC_MSG || atomic_flag_test_and_set_explicit(&pushing, memory_order_acquire)){
+		atomic_fetch_add(&dropped, 1);
+		atomic_fetch_add(&dropped_bytes, n);
+		return EOF;
+	}
+	h = atomic_load_explicit(&head, memory_order_relaxed);
+	t = atomic_load_explicit(&tail, memory_order_acquire);
+	if (h - t + 1 + n > LCD_ASYNC_SIZE){
+		if (overflow == LCD_DROP_NEWEST){
+			atomic_fetch_add(&dropped, 1);
+			atomic_fetch_add(&dropped_bytes, n);
+			atomic_flag_clear_explicit(&pushing, memory_order_release);
+			return EOF;
+		}
+		// take back the oldest messages, unless the writer claims them first
+		while (h - t + 1 + n > LCD_ASYNC_SIZE){
+			unsigned lose = 1 + buf[t & MASK];
+			if (atomic_compare_exchange_weak(&tail, &t, t + lose)){
+				atomic_fetch_add(&dropped, 1);
+				atomic_fetch_add(&dropped_bytes, lose - 1);	// not the length byte
+				t += lose;
+			}
+		}
+	}
+	buf[h & MASK] = (uint8_t)n;
+	for (i = 0; i < n; i++) buf[(h + 1 + i) & MASK] = d[i];
+	atomic_store_explicit(&head, h + 1 + n, memory_order_release);
+	atomic_flag_clear_explicit(&pushing, memory_order_release);
+	atomic_fetch_add(&queued, 1);
+	timing_sem_post(&wake);
+	return 0;
+}
+
+int lcd_async_putc(int c){
+	uint8_t b;
+	if (c > 255 || c < 0) return EOF;
+	b = (uint8_t)c;
+	return push(&b, 1) == EOF ? EOF : c;
+}
+
+int lcd_async_puts(const char *s){
+	int n = (int)strlen(s);
+	return push((const uint8_t*)s, n) == EOF ? EOF : n;
+}
+
+int lcd_async_printf(const char *format, ...){
+/* same buffer and return value as printf_lcd(), fmt.c keeps it bounded */
+	int n;
+	char string[80];
+	va_list args;
+	va_start(args, format);
+	n = fmt_vformat(string, 80, format, args);
+	va_end(args);
+	if (n <= 0) return -1;
+	if (lcd_async_puts(string) == EOF) return EOF;
+	return n;
+}
+
+uint32_t lcd_async_dropped(void){
+	return atomic_load(&dropped);
+}
+
+uint32_t lcd_async_dropped_bytes(void){
+	return atomic_load(&dropped_bytes);
+}
+
+uint32_t lcd_async_queued(void){
+	return atomic_load(&queued);
+}
+
+static void* lcd_writer(void *arg){
+/* drains the ring into the screen model and flushes, until stopped and empty */
+	uint8_t msg[LCD_ASYNC_MSG];
+	unsigned h, t, n, i;
+
+	while (1){
+		timing_sem_wait(&wake);
+		while (1){
+			t = atomic_load_explicit(&tail, memory_order_acquire);
+			h = atomic_load_explicit(&head, memory_order_acquire);
+			if (h == t) break;
+			n = buf[t & MASK];
+			for (i = 0; i < n; i++) msg[i] = buf[(t + 1 + i) & MASK];
+			// claim the copy, fails if the producer dropped this message
+			if (!atomic_compare_exchange_strong(&tail, &t, t + 1 + n)) continue;
+			for (i = 0; i < n; i++) lcd_screen_putc(msg[i]);
+			if (atomic_load(&head) == t + 1 + n) lcd_flush();	// caught up
+		}
+		if (!atomic_load(&running)) break;
+	}
+	return NULL;
+}
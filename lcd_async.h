@@ -0,0 +1,41 @@
+/*
+ * lcd_async.h
+ * Author: Trenton
+ * Date: 04/11/25
+ * Description: Non-blocking LCD output for ISR threads.
+ * Characters are pushed into a single-producer/single-consumer lock-free
+ * ring and a low priority writer thread drains the ring into the LCD
+ * screen model (lcd.c) and flushes it. The producer never waits on the
+ * UART, when the ring is full whole messages are dropped and counted.
+ *
+ * While the writer runs it owns the screen model, so every thread that
+ * prints (the ISR and the main loop) goes through lcd_async, not
+ * lcd_printf(). A push that runs into another thread's push is dropped.
+ */
+
+#ifndef LCD_ASYNC_H
+#define LCD_ASYNC_H
+
+#include <stdint.h>
+
+#define LCD_ASYNC_SIZE 256	// ring size in bytes, power of 2
+#define LCD_ASYNC_MSG 255	// longest message, one length byte each
+
+/* what to drop when a message doesn't fit */
+typedef enum {
+	LCD_DROP_NEWEST = 0,	// reject the new message whole
+	LCD_DROP_OLDEST			// discard the oldest queued messages to make room
+} Lcd_Overflow;
+
+int lcd_async_start(Lcd_Overflow policy);	// start writer thread, 0 or -1 (output synchronous)
+void lcd_async_stop(void);		// drain the ring and join the writer, if started
+
+int lcd_async_putc(int c);		// queue c, returns c or EOF if dropped
+int lcd_async_puts(const char *s);	// queue s, returns length or EOF if dropped
+int lcd_async_printf(const char *format, ...);	// like printf_lcd, never blocks
+
+uint32_t lcd_async_dropped(void);	// messages dropped since start
+uint32_t lcd_async_dropped_bytes(void);	// characters in those messages
+uint32_t lcd_async_queued(void);	// messages accepted since start
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ * lineedit.c
+ * Author: Trenton
+ * Date: 05/02/25
+ * Description: Keypad line editor, see lineedit.h.
+ */
+
+/* includes */
+#include "MyRio.h"
+#include "T1.h"
+#include "lineedit.h"
+
+// Functions ###################################################################
+
+void line_init(Line_Edit *le, char *buf, int size, Line_Echo echo){
+	le->buf = buf;
+	le->size = size;
+	le->echo = echo;
+	line_clear(le);
+}
+
+void line_clear(Line_Edit *le){
+	le->n = 0;
+	le->done = 0;
+	if (le->size > 0) le->buf[0] = '\0';
+}
+
+Line_Status line_key(Line_Edit *le, char key){
+/* keys after ENT are ignored until line_clear() */
+	if (le->done) return LINE_DONE;
+	if (key == ENT){
+		le->done = 1;
+		return LINE_DONE;
+	}
+	if (key == DEL){
+		if (le->n > 0){
+			le->buf[--le->n] = '\0';
+			if (le->echo){
+				le->echo('\b');		// move cursor left,
+				le->echo(' ');		//  to clear previous character on lcd
+				le->echo('\b');		// then reset position.
+			}
+		}
+		return LINE_MORE;
+	}
+	if (le->n >= le->size - 1) return LINE_FULL;
+	le->buf[le->n++] = key;
+	le->buf[le->n] = '\0';
+	if (le->echo) le->echo(key);
+	return LINE_MORE;
+}
@@ -0,0 +1,42 @@
+/*
+ * lineedit.h
+ * Author: Trenton
+ * Date: 05/02/25
+ * Description: Keypad line editor.
+ * The caller owns a Line_Edit and the buffer it fills, so any number of
+ * lines can be edited at once. Keys are fed in one at a time with
+ * line_key(), which never waits for the keypad. A control loop or FSM
+ * state can take a key from keypad_poll() each tick and keep running
+ * while the operator types.
+ *
+ * The buffer always holds the line so far, '\0' terminated. DEL removes
+ * the last key, ENT finishes the line. Keys past size-1 are refused.
+ * Each accepted key and DEL is echoed through the echo function, e.g.
+ * putchar_lcd, or lcd_async_putc from a time critical thread, or NULL.
+ */
+
+#ifndef LINEEDIT_H
+#define LINEEDIT_H
+
+typedef int (*Line_Echo)(int c);	// putchar_lcd() style
+
+typedef struct {
+	char *buf;			// caller's buffer
+	int size;			// buffer size, the line holds size-1 keys
+	int n;				// keys in the line
+	int done;			// ENT seen
+	Line_Echo echo;		// NULL for no echo
+} Line_Edit;
+
+/* line_key() results */
+typedef enum {
+	LINE_MORE = 0,		// key taken (or DEL on an empty line), not done
+	LINE_DONE,			// ENT, the line is complete
+	LINE_FULL			// key refused, the line is full
+} Line_Status;
+
+void line_init(Line_Edit *le, char *buf, int size, Line_Echo echo);
+Line_Status line_key(Line_Edit *le, char key);	// feed one key, never blocks
+void line_clear(Line_Edit *le);		// empty the line, start over
+
+#endif
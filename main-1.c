@@ -9,20 +9,18 @@
 /* includes */
 #include <stdio.h>
 #include <stdarg.h>
-#include <string.h>
 #include "MyRio.h"
 #include "T1.h"
+#include "lcd.h"	// LCD screen model, batched output
+#include "numparse.h"	// one pass number check and conversion
+#include "fmt.h"	// bounded time formatting
 
 /* prototypes */
 double double_in(char *prompt);	//validates and stores user number input
 int printf_lcd(const char *format,...); //prints to LCD
+int putchar_lcd(int c);	//writes char to LCD through the screen model
 
 char * fgets_keypad(char *buffer, int bufferlen); // takes input from keypad
-int sscanf(const char *s, const char *format, ...); //converts one type to another
-
-char* strpbrk(const char *s1, const char *s2); //first occurrence of a character
-char* strchr(const char *s, int c); //first occurrence of c in s
-char* strrchr(const char *s, int c); //last occurrence of c in s
 
 // main program loop ###################################################################
 int main(int argc, char **argv){
@@ -62,60 +60,25 @@ double double_in(char *prompt){
 	 *double_in() function
 	 *input parameter: prompt string pointer
 	 *takes user keypad input, terminated by entr, performs error checking, returns value as float
-	 *errors checked for: empty value, up or down key, double radix, negative not in first position (including double use)
-	 *TODO errors to be checked: "-." returns null if first value, returns previous value if second input.
+	 *errors checked for: empty value, up or down key, double radix, negative not in first position (including double use),
+	 *	no digits at all ("-", ".", "-.")
+	 *The checks and the conversion are one pass over the input, num_parse() in numparse.c,
+	 *	which also gives int and fixed-point results to callers that don't want a double.
 	 */
 
-	//declare variables
-	int error = 1;			// initialize/set error flag
-	char buffer [40];	// declare string user input will be stored in
-	double value;			// initialize value, what will be returned by the function
-
-	// clear display
-	putchar_lcd('\f');
-
-	//function loop
-	while (error == 1){
-		//putchar_lcd('\f');	// clear display
-		putchar_lcd('\v');	// move to first line of display
-		printf_lcd(prompt);	// print given function prompt
-		buffer[0] = '\0';	// empties buffer each while loop iteration (clears bad input data)
-
-		// take user input
-		fgets_keypad(buffer,40);	// puts input characters into string, terminated by enter
-
-		// test user input, return error messages if bad input, allow user to re-enter input
-		// test if string is empty
-		if (buffer[0] == '\0'){
-			putchar_lcd('\f');				// clear lcd
-			printf_lcd("\n");				// go to second line
-			printf_lcd("Short. Try Again");	// display error message
-			continue;						// go back to top of while loop so user can re-enter value
-
-		// test if string has extra "-" || up or down key pressed || two '.' in string
-		}else if((strpbrk(buffer,"[]")!= NULL) || (strpbrk(buffer+1,"-")!= NULL) || (strchr(buffer,'.') != NULL && strchr(buffer,'.') != strrchr(buffer,'.'))){
-			putchar_lcd('\f');
-			printf_lcd("\n");
-			printf_lcd("Bad Key. Try Again");
-			continue;
-		}else{
-			// input was validated as a number.
-			error = 0;	// set error to 0 to end loop
-			//TODO throw error for "-."
-		}
-	}
+	Num_Value v;			// digits and radix position of the input
 
-	// convert ascii string to double (long float)
-	sscanf(buffer, "%lf", &value);
-	// return float val
-	return value;
+	num_in(prompt, &v);		// prompt until the input is a valid number
+	return num_double(&v);	// return float val
 }
 
 int printf_lcd(const char *format,...){
 	/*
 	 * printf_lcd() function
 	 * input: format string with variable number of arguments
-	 * action: prints string to LCD via putchar_lcd
+	 * action: prints string to LCD. The string is written into the
+	 * 	LCD screen model (same escapes as putchar_lcd), then only the
+	 * 	cells that changed are sent, in one Uart_Write.
 	 * output: number of characters in string, or negative value for error
 	 */
 
@@ -123,7 +86,7 @@ int printf_lcd(const char *format,...){
 	char string[80]; //buffer
 	va_list args;
 	va_start(args, format);							// start parse
-		n = vsnprintf(string, 80, format, args); 	// parse to C string
+		n = fmt_vformat(string, 80, format, args); 	// parse to C string (fmt.c)
 	va_end(args);									// end parse
 
 	//detect conversion error
@@ -131,12 +94,33 @@ int printf_lcd(const char *format,...){
 		return -1;	// return -1 to signify error in parsing
 	}
 
-	char *p = string;	// initialize pointer to string
-	while (*p) putchar_lcd(*p++);	// iterate through string
+	lcd_screen_puts(string);	// update screen model
+	lcd_flush();				// send changed cells in one write
 
 	return n;	// return n, number of characters in string
 }
 
+int putchar_lcd(int c){
+	/*
+	 * putchar_lcd() function
+	 * input: character or escape ('\f', '\v', '\n', '\b')
+	 * action: replaces the T1 version so the clears, the prompts' cursor
+	 * 	moves and the keypad echo in num_in() go through the screen model
+	 * 	too. A write around the model would leave its copy of the display
+	 * 	stale, and the next printf_lcd() diff would land in the wrong cells.
+	 * output: c, or EOF for error
+	 */
+
+	if (c > 255 || c < 0){
+		return EOF;	// invalid code
+	}
+	lcd_screen_putc(c);			// update screen model
+	if (lcd_flush() == EOF){	// send changed cells
+		return EOF;
+	}
+	return c;
+}
+
 
 
 
@@ -3,12 +3,13 @@
  * Author: trenton
  * Date: 01/31/2025
  *
- * Description: This lab demonstrates my own getchar_keypad() function.
+ * Description: This lab demonstrates my own fgets_keypad() and getchar_keypad() functions.
  * The main code block calls fgets_keypad() twice and prints each value to the LCD and console for validation.
  *
- * getchar_keypad() acquires a single character from the keypad at a time.
- * It is added to a buffer, which is displayed on the the LCD.
- * When ENTR is pressed, the buffer is cleared one character at a time by fgets_keypad().
+ * fgets_keypad() acquires a single character from the keypad at a time.
+ * It is added to the caller's buffer and displayed on the LCD.
+ * When ENTR is pressed, the buffer holds the finished string.
+ * getchar_keypad() hands out a line from fgets_keypad() one character at a time.
  *
  * The delete key works as expected on the buffer.
  * DEL removes the previous character from the buffer and lcd.
@@ -19,15 +20,18 @@
  * Function Hierarchy:
  *
  * fgets_keypad()		//acquire string of chars
- * 	|-getchar_keypad()	//one char. from input
+ * 	|-line_key()		//edit the line (lineedit.c)
  * 		|-putchar_lcd()	//one char. to input
- * 		|-getkey()		//get 1 char from keypad
+ * 	|-getkey()		//get 1 char from keypad
+ * getchar_keypad()		//one char. from a line, compatibility
+ * 	|-fgets_keypad()
  */
 
 /* includes */
 #include <stdio.h>
 #include "MyRio.h"
 #include "T1.h"
+#include "lineedit.h"	// keypad line editor
 
 /* prototypes */
 int printf_lcd(const char *format,...); 			// prints to LCD
@@ -38,12 +42,12 @@ int putchar_lcd(int c);								// writes char to lcd screen
 int getchar_keypad(void); // returns a single character from the keypad as an int
 
 /* Definitions */
-#define buf_len 22		// Length of the buffer (final char is EOF)
+#define buf_len 22		// Length of the buffers, including the '\0'
 
 // main program loop ###################################################################
 int main(int argc, char **argv){
 /*
- * main() tests the function getchar_keypad() by calling fgets_keypad() twice,
+ * main() tests the function fgets_keypad() by calling it twice,
  * then prints the strings to console and lcd via printf_lcd().
  * main() also includes two user prompts and output display formatting.
  */
@@ -57,7 +61,7 @@ int main(int argc, char **argv){
     char input1[buf_len];
     char input2[buf_len];
 
-    // Test getchar_keypad()
+    // Test fgets_keypad()
     // call fgets_keypad() function twice
     putchar_lcd('\f');				// clear display
     putchar_lcd('\v');				// move to first line of display
@@ -85,69 +89,48 @@ int main(int argc, char **argv){
 }
 
 // Functions ###########################################################################
-int getchar_keypad(void){
+char * fgets_keypad(char *buffer, int bufferlen){
 /*
- *  getchar_keypad() function
- *  input parameter: void
- *  This function has a buffer. It takes single keypad presses,
- *  	stores them to the buffer, prints them to the lcd,
- *  	and returns the buffer string when ENTR is pressed.
+ *  fgets_keypad() function
+ *  input parameters: buffer to fill, buffer length including the '\0'
+ *  Takes single keypad presses, echoes them to the lcd and stores them
+ *  	straight into the caller's buffer, until ENTR is pressed.
  *  Delete functionality: while there are characters in the buffer,
  *  	delete will remove the most recent char and step the input back.
  *  When the buffer is full: new inputs are not allowed, but delete can be used.
- *  The final character in the buffer will always be an EOF (end of file) character.
+ *  Returns buffer, always '\0' terminated.
+ *
+ *  The editing is done by a Line_Edit (lineedit.c) that lives on this
+ *  call's stack and points at the caller's buffer, so nothing is kept
+ *  between calls and nothing is copied.
  */
 
-	//Declare variables
-	static int n = 0;				// Counter variable for chars in buffer
-	static char buffer[buf_len];	// We'll be calling our buffer: "buffer"
-	static char *pointer;			// Pointer to our buffer: "pointer"
-	static char c;					// character value assigned by getkey()
-
-	// if empty buffer condition
-	if (n == 0){
-		pointer = buffer;	// set pointer to start of buffer
-		// while keypad button isn't ENTR
-		while ((c=getkey())!= ENT){
-			/* Delete Functionality
-			 * check if pressed key is delete and that n != 0.
-			 * we check that n !=0 so that del does nothing to lcd when empty,
-			 * otherwise the cursor would move left one space.
-			*/
-			if ((c == DEL) && n!=0){
-				pointer--;			// decrement pointer to previous value
-				*pointer = '\0';	// clear value by assigning NULL
-				putchar_lcd('\b');	// move cursor left,
-				putchar_lcd(' ');	//  to clear previous character on lcd
-				putchar_lcd('\b');	// then reset position.
-				n--;
-			}
-			// for all characters that aren't delete:
-			// check buf_len to ensure we don't exceed buffer size.
-			/* TODO fix bug: second to last buffer character can't be utilized.
-			 * There's one character of buffer overflow happening between calls and I can't find
-			 * the exact cause of it. With just buf_len-1 second input is skipped.*/
-			else if ((c != DEL)&&(n < (buf_len-2))){
-				*pointer++ = c;	// put c in buffer at location pointed to by pointer, increment pointer
-				n++; 			// increment n
-				putchar_lcd(c); // print c to LCD
-			}
-		}
-		n++;				// increment counter
-		pointer = buffer; 	// set pointer to start of buffer
-	}
+	Line_Edit line;		// editor state for this line
 
-	// if more than one character in buffer, after input, this returns buffer
-	if (n > 1){
-		n--;				// decrement n
-		return *pointer++;	//return character (in the form of an int) pointed to and increment pointer
-	}
-	// else (final character in buffer), send EOF
-	else{
-		n--;		// decrement n
-		return -1; 	// -1 is EOF (end of file) character
-	}
+	line_init(&line, buffer, bufferlen, putchar_lcd);
+	while (line_key(&line, getkey()) != LINE_DONE){}
+	return buffer;
 }
 
+int getchar_keypad(void){
+/*
+ *  getchar_keypad() function
+ *  input parameter: void
+ *  Compatibility shim for code that reads the keypad a character at a
+ *  	time: reads one line with fgets_keypad(), then hands it out one
+ *  	character (as an int) per call, then EOF.
+ */
 
+	static char line[buf_len];	// line being handed out
+	static int next = -1;		// next char to return, -1 = no line yet
 
+	if (next < 0){
+		fgets_keypad(line, sizeof(line));
+		next = 0;
+	}
+	if (line[next] != '\0'){
+		return line[next++];
+	}
+	next = -1;	// the next call starts a new line
+	return EOF;
+}
@@ -20,11 +20,12 @@
 #include "T1.h"
 #include "UART.h"	// For UART communication with MyRIO
 #include "DIO.h"	// For digital input output pin use
+#include "lcd.h"	// shared LCD UART and screen model
+#include "keypad.h"	// scanned keypad with debounced key events
 
 /* prototypes */
 int putchar_lcd(int c);	//takes character input, prints to lcd
 char getkey(void);		//identifies keypad key depressed
-void wait2(void);		// WAIT
 
 NiFpga_Bool Dio_ReadBit(MyRio_Dio *channel);	// reads dio bit, sets channel to high-z
 void Dio_WriteBit(MyRio_Dio *channel, NiFpga_Bool value);	// digital output write
@@ -84,6 +85,7 @@ int main(int argc, char **argv){
 	putchar_lcd('\b');						// test '\b'
 	fgets_keypad(test2,buf_len);			// collect buffered string
 	printf_lcd("\nString: %s", test2);		// display string to lcd
+	keypad_stop();							// stop the keypad scan thread
 
 	//MyRio ending code - required by hardware -----------------------------------------
 	status = MyRio_Close();						// close FPGA session
@@ -106,68 +108,23 @@ int putchar_lcd(int c){
  * 		-return character to calling program
  * 		-else: return EOF
  *
+ * The UART port and a shadow copy of the display live in lcd.c.
+ * c goes into the copy and only the cells that changed are sent,
+ * printf_lcd() works the same way for a whole string.
  */
 
-	// Function Variables
-	static int i = 0;	// default i value, indicates UART hasn't been opened
-	uint8_t d[2];		// data array sized to accommodate escape sequences
-	int n = 1;			// assume length of character array is 1
-
-	// UART Variables
-	static MyRio_Uart uart;	// port information structure
-	int baud_rate = 19200;	// T1 target display baud rate
-	NiFpga_Status status;	// returned value
-
 	// Check for first function call, if so initialize UART
-	if (i==0){
-		uart.name = "ASRL2::INSTR";				// UART on connector B
-		uart.defaultRM = 0;						// define resource manager
-		uart.session = 0;						// session reference number
-		status = Uart_Open(&uart,				// port information
-							baud_rate,			// baud rate, bits per second
-							8,					// number of data bits
-							Uart_StopBits1_0,	// 1 stop bit
-							Uart_ParityNone);	// no parity bit
-		// check for success of connection, return error flag if unsuccessful
-		if (status < VI_SUCCESS){
-			return EOF;
-		}
-		i = 1;	// change index to show uart connection has been established
-	}
-	// Check for escape sequences, convert them to decimal equivalents via cast
-	if ((c == '\b') || (c == '\f') || (c == '\n') || (c == '\v')){
-		d[0] = (uint8_t)c;		// cast c to ASCII decimal
-
-		/* this stupid system uses '\n' to mean '\n''\r'
-		// '\r' is carriage return and moves cursor to beginning of current line
-		// so this functionality has to be hard coded in.
-		// ascii \n = 10, \r = 13
-		// This stupid hardware also thinks \r is \n\r.
-		*/
-		if (c == '\n'){
-			d[0] = 13;		// sighs
-		}
-		// '\f' requires a second code for our purposes
-		if (c == '\f'){
-			d[1] = 17;			// set second array value
-			n = 2;				// update number of data codes
-		}
+	if (lcd_open() == EOF){
+		return EOF;
 	}
 	// Check if c is outside extended ASCII range
-	else if (c>255 || c<0){
+	if (c>255 || c<0){
 		return EOF;				// throw error flag
 	}
-	// c is regular ASCII, set write array to its decimal value
-	else{
-		d[0] = (uint8_t)c;
-	}
-	//Uart_Write takes 3 inputs: &uart, d, n
-	// and writes characters to lcd
-	status = Uart_Write(&uart,	// port information
-						d,		// data array
-						n);		// number of data codes
-	// check for unsuccessful write
-	if (status < VI_SUCCESS){
+	// put c in the screen model ('\n','\f','\b','\v' move the cursor)
+	lcd_screen_putc(c);
+	// send the changed cells to the lcd, check for unsuccessful write
+	if (lcd_flush() == EOF){
 		return EOF;				// throw error flag
 	}
 	// successful write!
@@ -185,100 +142,19 @@ char getkey(void){
 	 * This is repeated for each column as all keys are scanned.
 	 *
 	 * Function Pseudo Code
-	 * -initialize DIO channels
-	 * -b set true
-	 * -for each column c
-	 * 		-for each column C
-	 * 			-read C to set high-Z input
-	 * 		-write low to c
-	 * 		-for each row r
-	 * 			-read r to b
-	 * 			-if b is false		//check for depressed key
-	 * 				-break row loop
-	 * 		-if b is false
-	 * 			-break column loop
-	 * 		-else
-	 * 			wait ## ms			// delay rescan
-	 * -wait for key to be depressed
-	 * 		-wait ## ms				// prevent unintended duplicates
-	 * -lookup key in table
-	 * -return value
+	 * -start the keypad scan thread the first time getkey() is called
+	 * -wait for the next key release event
+	 * -return its value
 	 *
+	 * The scan, debounce and lookup table live in keypad.c. The scan thread
+	 * runs every 5 ms and queues press/release events, so keys pressed
+	 * between calls aren't lost and the caller only wakes for an event.
 	 */
 
-	// function variables
-	NiFpga_Bool b = NiFpga_True;	// set b to true, flagged false when key depressed
-
-	int c;		// column identifier
-	int Col;	// also column identifier
-	int r;		// row identifier
-
-	// Key Code Lookup Table
-	const char table[4][4] ={
-			{'1', '2', '3', UP},
-			{'4', '5', '6', DN},
-			{'7', '8', '9', ENT},
-			{'0', '.', '-', DEL}
-	};
-
-	// DIO Channel Initialization
-	MyRio_Dio ch[8];				// array of channels
-	int i;
-	for (i = 0; i < 8; i++){	// in DIOB_70 register bank
-		ch[i].dir = DIOB_70DIR;		// line direction (output/input) bit
-		ch[i].out = DIOB_70OUT;		// output bit
-		ch[i].in = DIOB_70IN;		// input bit
-		ch[i].bit = i;				// bit index
-	}
-	// Run this loop until a key is depressed
-	while (b == NiFpga_True){
-		for (c = 0; c<4; c++){
-			//cycles through each column
-			for (Col = 0; Col<4; Col++){
-				NiFpga_Bool bit = Dio_ReadBit(&ch[Col]);	// sets all columns to high-z
-			Dio_WriteBit(&ch[c], NiFpga_False);				// sets current column to low-z
-			}
-			// cycles through each row
-			for (r = 4; r<8; r++){
-				b = Dio_ReadBit(&ch[r]);	// reads if current block is set high or low
-				// identifies that a key has been depressed, leaves row loop
-				if (b == NiFpga_False){
-					break;
-				}
-			}
-			// identifies that a key has been depressed, leaves column loop
-			if (b == NiFpga_False){
-				break;
-			}
-			// wait for everything to stabilize before repeating/duplicating
-			else{
-				wait2();
-			}
-		}
-	}
-	// waits to return character until it is depressed
-	// doesn't send pressed down character
-	while (Dio_ReadBit(&ch[r])==NiFpga_False){
-		wait2();
-	}
-	char k = table[r-4][c];	//uses lookup table to return keypad value
-	return k;
-
-}
-
-void wait2(void){
-	/*
-	 * This function waits for the prescribed amount of milliseconds.
-	 * Literally wastes time and electricity counting down.
-	 * From textbook
-	 */
-	uint32_t i;
-	i = 417000;
-	while (i>0){
-		i--;
+	static int started = 0;		// scan thread running
+	if (!started){
+		keypad_start(KEYPAD_SCAN_NS);
+		started = 1;
 	}
-	return;
+	return keypad_getkey();		// waits until a key is released
 }
-
-
-
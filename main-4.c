@@ -18,14 +18,22 @@
 #include "T1.h"
 #include "matlabfiles.h"
 #include "UART.h"
+#include "timing.h"	// deadline based FSM tick
+#include "numparse.h"	// keypad number input
+#include "lcd.h"	// LCD screen model, lcd_printf()
+#include "telem.h"	// telemetry stream to disk
+#include "capture.h"	// columnar capture file
+#include "pwm.h"	// run pin PWM on the timer IRQ
+#include "workq.h"	// deferred work for the FSM
 //#include "emulate.h" // used for motor emulation, has limitations
 
 /* prototypes ------------------------------------------*/
-double double_in(char *string);
-void wait(void);
 void initializeSM(void);
 void initializeHardware(void);
 double vel(void);
+double rpmOf(double speed);
+void jobDisplay(void *ctx, const Workq_Arg *arg);
+void jobRecord(void *ctx, const Workq_Arg *arg);
 NiFpga_Status EncoderC_initialize(NiFpga_Session myrio_session,
 		MyRio_Encoder *channel);	// Encoder initialize
 uint32_t Encoder_Counter(MyRio_Encoder *channel); // Encoder count retrieval
@@ -35,8 +43,7 @@ void Dio_WriteBit(MyRio_Dio *channel, NiFpga_Bool value); // Digital output writ
 
 /* definitions -----------------------------------------*/
 typedef enum {
-	STATE_LOW = 0,
-	STATE_HIGH,
+	STATE_RUN = 0,
 	STATE_SPEED,
 	STATE_STOP,
 	STATE_EXIT,
@@ -44,6 +51,9 @@ typedef enum {
 } State_Type; // enumeration of states
 static State_Type curr_state; // current state
 static int clock_count;
+#define TICK_NS (5*TIMING_NS_PER_MS) // FSM tick period: 5 ms
+#define TICK_US (TICK_NS/TIMING_NS_PER_US) // N and M are in these
+static Tick fsm_tick; // FSM tick deadlines
 /* State Functions Array of Pointers*/
 static void (*state_table[NUM_STATES])(void);
 // Encoder global variables
@@ -53,47 +63,54 @@ static int N; // number of wait periods
 static int M; // number of on periods
 // DIO
 MyRio_Dio run;
+static Pwm pwm; // drives run, N*5 ms period, M*5 ms on
 MyRio_Dio printS;
 MyRio_Dio stopS;
 //Problem L4.7 Print to MATLAB
 #define IMAX 200			//max points
 static double buffer[IMAX];	//speed buffer
 static double *bp = buffer;	//buffer pointer
+// every speed sample, streamed to Lab4_trenton.cap (telem.h, capture.h)
+static Telem tlm;
+static Capture cap;
+// LCD print and buffer append, off the FSM tick (workq.h)
+static Workq jobs;
 
 /* State Functions ----------------------------------------*/
-void stateLOW(void){
-/* Resets clock count, raises wave, detects stopS and printS */
-	// detect if BTI has ended
-	if (clock_count == N){
+void stateRUN(void){
+/* The PWM on run keeps going on its own (pwm.c), this state only
+ * checks stopS and printS, once per PWM period (every N ticks) */
+	if (clock_count >= N){
 		clock_count = 0; // reset clock count
-		Dio_WriteBit(&run, NiFpga_True); // set run to high
 
 		// check if stopS is pressed
 		if (Dio_ReadBit(&stopS) == NiFpga_True){
 			curr_state = STATE_STOP;
-			Dio_WriteBit(&run, NiFpga_False);
 		}
 		// check if printS is pressed
 		else if (Dio_ReadBit(&printS) == NiFpga_True){
 			curr_state = STATE_SPEED;
 		}
-		// no button presses, goes to high state
-		else{
-			curr_state = STATE_HIGH;
-		}
 	}
 }
 
-void stateHIGH(void){
-/*Once clock reaches M or >M, changes run and curr_state to LOW*/
-	if(clock_count >= M){
-		Dio_WriteBit(&run, NiFpga_False); // set run to low
-		curr_state = STATE_LOW;
-	}
+void stateSPEED(void){
+/* calls vel() and hands the rest to the worker thread (workq.c):
+ * jobDisplay() prints the RPM to the LCD, jobRecord() saves it to the
+ * matlab buffer and the capture. The encoder is still read on the tick,
+ * posting the jobs takes the same short time whatever they cost, so the
+ * tick never runs long.
+ */
+	Workq_Arg job;
+	job.v[0] = vel();			// BDI/BTI
+	job.t = timing_now();		// sample time (ns)
+	workq_post(&jobs, jobDisplay, NULL, &job);
+	workq_post(&jobs, jobRecord, NULL, &job);
+	curr_state = STATE_RUN; 	// sets current state to RUN
 }
 
-void stateSPEED(void){
-/* calls vel(), calculates RPM, prints RPM to LCD
+double rpmOf(double speed){
+/* RPM from vel()
  * vel = BDI/BTI, BDI/2048 = revolutions
  * BTI * wait_time * N wait periods = seconds
  * seconds / 60 = minutes
@@ -101,23 +118,34 @@ void stateSPEED(void){
  * 	rpm = num / denom
  * 	num = vel/2048
  * 	denom = wait_time * N / 60
- * This function has a long runtime which leads to issues
  */
-	double wait_time = 0.005; // (seconds) wait() computed time: 5 ms
-	double rpm = (vel() * 60)/(2048.0 * N * wait_time); // rpm
-	printf_lcd("\fspeed: %g rpm",rpm); 	// print calculated rpm to LCD
-	curr_state = STATE_HIGH; 	// sets current state to HIGH
-	// Matlab code 
+	double wait_time = (double)TICK_NS / TIMING_NS_PER_S; // (seconds) FSM tick: 5 ms
+	return (speed * 60)/(2048.0 * N * wait_time); // rpm
+}
+
+void jobDisplay(void *ctx, const Workq_Arg *arg){
+/* worker thread: arg->v[0] = vel() */
+	lcd_printf("\fspeed: %g rpm", rpmOf(arg->v[0])); 	// print calculated rpm to LCD (bounded %g)
+}
+
+void jobRecord(void *ctx, const Workq_Arg *arg){
+/* worker thread: arg->v[0] = vel(), arg->t = sample time (ns) */
+	double rpm = rpmOf(arg->v[0]);
+	// Matlab code
 	if (bp < buffer + IMAX) {
 		*bp++ = rpm;
 	}
+	telem_push(&tlm, arg->t, &rpm);	// keeps going after buffer is full
 }
 
 void stateSTOP(void){
 /* stops supplying power to motor, signals stopping, signals exit
  * and saves response to a MATLAB file.
  */
-	Dio_WriteBit(&run, NiFpga_False); // verify run is low
+	pwm_stop(&pwm); // PWM off, run low
+	pwm_print(&pwm);
+	workq_stop(&jobs); // the last speed prints and samples
+	if (workq_dropped(&jobs)) printf("jobs dropped %u\n", workq_dropped(&jobs));
 	printf_lcd("\fstopping.");
 	curr_state = STATE_EXIT;
 	//save matlab file
@@ -132,11 +160,13 @@ void stateSTOP(void){
 	matfile_addmatrix(mf, "M", &Mc, 1, 1, 0);
 	matfile_addmatrix(mf, "vel", buffer, IMAX, 1, 0);
 	matfile_close(mf);		// close file
+	if (telem_close(&tlm) < 0) printf("telemetry write failed\n");
+	if (telem_dropped(&tlm)) printf("telemetry dropped %u\n", telem_dropped(&tlm));
 }
 
 /* state functions pointer array */
 static void (*state_table[])(void)={
-		stateLOW,stateHIGH,stateSPEED, stateSTOP
+		stateRUN, stateSPEED, stateSTOP
 };
 
 double vel(void){
@@ -186,30 +216,23 @@ void initializeSM(void){
 /* State Machine Initialization Function
  * Sets start conditions for FSM
  * 1) Set run = zero
- * 2) set initial state to low
+ * 2) set initial state to run
  * 3) set the clock count to zero
+ * The FSM tick is started in main() once N and M are entered.
  * DIO channel and encoder initialization are in
  *  initializeHardware() for improved readability.
  * */
 	Dio_WriteBit(&run, NiFpga_False);
-	curr_state = STATE_LOW;
+	curr_state = STATE_RUN;
 	clock_count = 0;
 }
 
-void wait(void) {
-  uint32_t i;
-  i = 417000;
-  while (i > 0) {
-    i--;
-  }
-  return;
-}
-
 int main(int argc, char **argv){
 /* Main Program Loop
  * Sets up MyRio connection. Initializes hardware connection
  * and Finite State Machine. Prompts user for N wait intervals
- * and M "on" intervals. Runs the FSM loop which calls to the
+ * and M "on" intervals, and starts the PWM on run with them.
+ * Runs the FSM loop which calls to the
  * current state and increases the clock count by 1 each loop.
  * When the state is EXIT, the program closes connection with MyRio*/
 	// MyRio connection code - required by hardware-------------------------------------
@@ -225,18 +248,50 @@ int main(int argc, char **argv){
 	initializeSM();
 
 	// Request user input for N wait intervals and M on intervals
-	N = double_in("Wait intervals:");
-	M = double_in("On intervals:");
+	// read as whole numbers directly, no double in between
+	Num_Value in;
+	num_in("Wait intervals:", &in);
+	N = num_int(&in);
+	num_in("On intervals:", &in);
+	M = num_int(&in);
 	// if M > N, request new M.
 	while (M >= N){
-		M = double_in("On intervals:");
+		num_in("On intervals:", &in);
+		M = num_int(&in);
+	}
+
+	// speed samples also go to a capture file as they come, no length limit
+	static const char *const cap_names[1] = {"vel"};
+	static const uint32_t cap_types[1] = {CAP_F64};
+	if (cap_open(&cap, "Lab4_trenton.cap", 1, cap_names, cap_types) < 0
+			|| cap_telem(&tlm, &cap) < 0) printf("Can't open capture file\n");
+
+	// worker for the slow parts of stateSPEED
+	if (workq_start(&jobs) < 0) printf("Can't start worker, jobs run in the FSM tick\n");
+
+	// PWM on run, N intervals period and M on, timed by the timer IRQ
+	// on its own real time thread
+	pwm_init(&pwm, &run, N*TICK_US, M*TICK_US);
+	Rt_Attr rt = RT_ATTR_ISR;
+	Rt_Status rt_status;
+	int32_t pwm_status = pwm_start(&pwm, &rt, &rt_status);
+	if (pwm_status != 0){
+		// no motor drive, nothing for the FSM to do
+		printf("Can't start PWM (%d)\n", (int)pwm_status);
+		pwm_stop(&pwm);		// run low
+		workq_stop(&jobs);
+		if (telem_close(&tlm) < 0) printf("telemetry write failed\n");
+		MyRio_Close();
+		return pwm_status;
 	}
+	rt_report("PWM", &rt, &rt_status);
 
 	// state machine loop
 	// shutdown if state is exit
+	tick_start(&fsm_tick, TICK_NS);	// first tick 5 ms from now
 	while(curr_state != STATE_EXIT){
 		state_table[curr_state]();	//call current state function
-		wait();						// calibrated wait period
+		tick_wait(&fsm_tick);		// sleep until the next 5 ms deadline
 		clock_count++;				// increment clock counter
 		}
 	//MyRio exit code - required by hardware -----------------------
@@ -17,10 +17,13 @@
 #include "T1.h"
 #include "DIIRQ.h"		// Lab 5 specific, threads
 #include <pthread.h>	// Lab 5 specific, threads
+#include "timing.h"		// deadline based waits
+#include "lcd_async.h"	// non-blocking LCD output, ISR and count
+#include "istat.h"		// IRQ service time
+#include "rtthread.h"	// real time ISR thread
 
 /* prototypes */
 //pthread prototypes included in pthread.h
-void wait5(void);		// 5 ms wait
 void countloop(int);	// waits 1 second and prints count
 void* DI_ISR(void *thread_resource);
 
@@ -29,6 +32,7 @@ typedef struct{
 	NiFpga_IrqContext irqContext;	// IRQ context reserved
 	NiFpga_Bool irqThreadRdy;		// IRQ thread ready flag
 	uint8_t irqNumber;				// IRQ number value
+	Istat stat;						// service time
 } ThreadResource;
 
 // main program loop #############################################################
@@ -39,7 +43,7 @@ int main(int argc, char **argv){
 2) Register the digital input (DI) interrupt.
 3) Create an interrupt thread to service the interrupt.
 4) Begin a loop. Each time through the loop, the following happens:
-	Wait 1 s by calling the (5 ms) wait() function 200 times.
+	Wait until the next 1 s deadline.
 	Clear the display and print the value of the count.
 	Increment the value of the count.
 5) After a count of 60, signal the interrupt thread to stop,
@@ -80,13 +84,30 @@ int main(int argc, char **argv){
 
 	// Set the ready flag to enable the new thread
 	irqThread0.irqThreadRdy = NiFpga_True;
+	istat_init(&irqThread0.stat, "DI IRQ");
 
 	// 3) Create interrupt thread for function ---------------------------------
+	// start the LCD writer first, the ISR and the count print through it
+	if (lcd_async_start(LCD_DROP_OLDEST) < 0){
+		printf("LCD writer didn't start, the ISR prints directly\n");
+	}
+	// real time priority on its own core, above the LCD writer
 	pthread_t thread;
-	irq_status = pthread_create(&thread,
-	                            NULL,                      // attr default ok
-	                            DI_ISR,                    // start routine
-	                            &irqThread0);
+	Rt_Attr rt = RT_ATTR_ISR;
+	Rt_Status rt_status;
+	irq_status = rt_thread_create(&thread,
+	                              &rt,                     // FIFO, pinned, locked
+	                              DI_ISR,                  // start routine
+	                              &irqThread0,
+	                              &rt_status);
+	if (irq_status != 0){
+		printf("Can't start DI_ISR (%d)\n", (int)irq_status);
+		lcd_async_stop();
+		Irq_UnregisterDiIrq(&irqDI0, irqThread0.irqContext, irqThread0.irqNumber);
+		MyRio_Close();
+		return irq_status;
+	}
+	rt_report("DI_ISR", &rt, &rt_status);
 
 	// 4) 1-60 second Count Loop -----------------------------------------------
 	int i;
@@ -101,6 +122,8 @@ int main(int argc, char **argv){
 	irq_status = Irq_UnregisterDiIrq(&irqDI0,
 								irqThread0.irqContext,
 								irqThread0.irqNumber);
+	lcd_async_stop();	// finish queued LCD output
+	istat_print(&irqThread0.stat);
 
 	// 7) MyRio session close - required by hardware ---------------------------
 	status = MyRio_Close();						// close FPGA session
@@ -132,8 +155,13 @@ void* DI_ISR(void *thread_resource){
 		         (NiFpga_Bool*) &(threadResource->irqThreadRdy));
 		// scheduler acknowledgement
 		if (irqAssert & (1 << threadResource->irqNumber)) {
-			/*  ISR code: print "interrupt_" to LCD */
-			printf_lcd("\finterrupt_");
+			// the edge time can't be read back, only the service time is kept
+			istat_wake(&threadResource->stat);
+			/*  ISR code: print "interrupt_" to LCD
+			 *  queued for the LCD writer thread, so the ISR doesn't wait
+			 *  on the UART */
+			lcd_async_puts("\finterrupt_");
+			istat_ack(&threadResource->stat);
 			Irq_Acknowledge(irqAssert);
 
 			/* Test code to check debounce
@@ -149,28 +177,21 @@ void* DI_ISR(void *thread_resource){
 	return NULL;
 }
 
-void countloop(i){
+void countloop(int i){
 	/*
 	 * Performs 1 second wait and prints current count
+	 * The 1 s ticks are absolute deadlines set up on the first call,
+	 * so the LCD print time doesn't add up over the 60 s count.
 	 */
-	int k;
-	// wait 1 second: 5ms wait * 200
-	for (k=0; k<200; k++){
-		wait5();
-	}
-	printf_lcd("\f%d",i); // print count value
-}
+	static Tick second;			// 1 s tick
+	static int started = 0;		// tick started flag
 
-void wait5(void){
-	/*
-	 * This function waits for the calibrated amount of milliseconds: 5ms.
-	 */
-	uint32_t i;
-	i = 417000;
-	while (i>0){
-		i--;
+	if (!started){
+		tick_start(&second, TIMING_NS_PER_S);
+		started = 1;
 	}
-	return;
+	tick_wait(&second);		// sleep until the next second
+	lcd_async_printf("\f%d",i); // print count value, through the LCD writer
 }
 
 
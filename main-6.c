@@ -21,17 +21,18 @@
 #include <pthread.h>	// linux multithreading
 #include "TimerIRQ.h"	// timer irq for interrupt method
 #include "matlabfiles.h"// matlab file creation
+#include "keypad.h"		// scanned keypad with debounced key events
+#include "regio.h"		// grouped register i/o for the ISR
+#include "biquad.h"		// biquad cascade filters
+#include "telem.h"		// telemetry stream to disk
+#include "capture.h"	// columnar capture file
+#include "timing.h"		// time stamps
+#include "istat.h"		// IRQ latency and service time
+#include "rtthread.h"	// real time ISR thread
+#include "rategrp.h"	// rate group scheduler on the timer IRQ
 
 //#include "emulate.h"	// emulated analog input for matlab file
 
-/* biquad structure for cascade()*/
-struct biquad {
-  double b0; double b1; double b2;   // numerator
-  double a0; double a1; double a2;   // denominator
-  double x0; double x1; double x2;   // input
-  double y1; double y2;              // output
-};
-
 /* prototypes  -------------------------------------------------------*/
 
 /* These prototypes are included in headers.
@@ -48,38 +49,42 @@ struct biquad {
 //double Aio_Read(MyRio_Aio *channel);
 */
 
-// ISR and interrupt scheduler
-void* Timer_ISR(void *thread_resource);
-
-// biquad cascade implementation
-double cascade(double xin,         // input
-               struct biquad *fa,  // biquad array
-               int    ns,          // no. segments
-               double ymin,        // min output
-               double ymax);       // max output
-
 /* definitions and macros----------------------------------------------*/
 
-//Globally defined thread resource structure
-typedef struct{
-	NiFpga_IrqContext irqContext;	// IRQ context reserved
-	NiFpga_Bool irqThreadRdy;		// IRQ thread ready flag
-} ThreadResource;
-
 NiFpga_Session myrio_session;	// myrio session macro required for book code template
 
-// saturation macro for cascade(), provided by book
-#define SATURATE(x,lo,hi) ((x) < (lo) ? (lo) : (x) > (hi) ? (hi) : (x))
-
 // MATLAB code
 #define IMAX 500				//max points
 
+#define NCH 2	// filtered channels: AIC0 -> AOC1, AIC1 kept for the telemetry only
+#define BASE_US 500	// T - us; f_s = 2000 Hz, (500=0.5ms), scheduler base tick
+
+// filter task state, set up before the scheduler starts
+typedef struct{
+	MyRio_Aio AIC0, AIC1;	// C, analog inputs 0 and 1
+	MyRio_Aio AOC1;			// C, analog output 1, the only one driven
+	Io_Tx io;				// channels read and written each tick
+	int ai[NCH], ao;		// Io_Tx slots of the inputs and of AOC1
+	Bq_Multi filter;		// one cascade per channel
+	double buffer1[IMAX];	// v_in
+	double buffer2[IMAX];	// v_out
+	int n;					// points in the buffers
+	Telem tlm;				// AIC0, AOC1, AIC1 and its filtered value every tick
+	Capture cap;			// where tlm goes
+} Filter_Task;
+
+// tasks run by the rate group scheduler
+void filter_open(Filter_Task *f);
+void filter_tick(void *task);
+void filter_close(Filter_Task *f);
+
 
 
 // main program loop #############################################################
 int main(int argc, char **argv){
 /* Description of main()
- *	main() initializes our program and creates the thread that Timer_ISR operates on.
+ *	main() initializes our program and starts the scheduler that runs
+ *		filter_tick() on the timer interrupt.
  *	A while loop controls the program's runtime, pressing "<-" on the keypad
  *		signals for the ISR thread to shutdown, threads are cleaned,
  *		then the whole program terminates.
@@ -88,10 +93,11 @@ int main(int argc, char **argv){
  *
 1) Open the myRIO session.
 2) initialize analog channels on connector C
-3) Set up Time IRQ interrupt thread
+3) Set up the filter task and start the rate group scheduler (rategrp.c),
+	it registers the timer IRQ and runs the ISR thread
 4) enter a loop until "<-" is pressed on the keypad (use getkey() )
-5) After loop end, signal timer thread to terminate using irqThreadRdy flag
-6) Unregister the interrupt.
+5) After loop end, stop the scheduler, which ends the ISR thread
+6) and unregisters the interrupt. Save the filter's mat file.
 7) Close myRIO session.
 */
 
@@ -100,32 +106,42 @@ int main(int argc, char **argv){
 	status = MyRio_Open();		    				// open FPGA session
 	if (MyRio_IsNotSuccess(status)) return status;	// test if session opened
 
-	// 3) configure timer interrupt and create timer thread ----------------------
+	// 3) filter task on every tick, scheduler on the timer interrupt -------------
 	int32_t irq_status;
-	MyRio_IrqTimer irqTimer0;
-	ThreadResource irqThread0;
-	pthread_t thread;
-	irqTimer0.timerWrite = IRQTIMERWRITE;	// irq channel registers
-	irqTimer0.timerSet = IRQTIMERSETTIME;
-	uint32_t timeoutValue = 500;			// (micro seconds)
-	irq_status = Irq_RegisterTimerIrq(&irqTimer0,
-										&irqThread0.irqContext,
-										timeoutValue);
-	// set indicator to allow new thread
-	irqThread0.irqThreadRdy = NiFpga_True;
-	// create thread calling Timer_ISR()
-	irq_status = pthread_create(&thread, NULL, Timer_ISR, &irqThread0);
+	static Rg_Sched sched;
+	static Filter_Task filter;
+	filter_open(&filter);
+	rg_init(&sched, BASE_US);
+	rg_add(&sched, "filter", 1, 0, 0, filter_tick, &filter);	// 2 kHz
+	// ISR thread at real time priority on its own core
+	Rt_Attr rt = RT_ATTR_ISR;
+	Rt_Status rt_status;
+	irq_status = rg_start(&sched, &rt, &rt_status);
+	if (irq_status != 0){
+		printf("Can't start the timer ISR (%d)\n", (int)irq_status);
+		filter_close(&filter);
+		MyRio_Close();
+		return irq_status;
+	}
+	rt_report("Timer IRQ", &rt, &rt_status);
 
 	// 4) enter main loop --------------------------------------------------------
 	printf_lcd("\fRunning\n\nTo stop: <- key"); // Signal program start to user
 
 	// while "<-" hasn't been pressed on the keypad, loop (let ISR run)
-	while ( (getkey() != DEL) ){}
+	// the scan thread queues key events, this thread sleeps until one arrives
+	// ENT prints the ISR's latency, service time and overruns so far
+	keypad_start(KEYPAD_SCAN_NS);
+	char key;
+	while ( (key = keypad_getkey()) != DEL ){
+		if (key == ENT) rg_print(&sched);
+	}
+	keypad_stop();
 
 	// ) Terminate ISR and unregister interrupt -----------------------------
-	irqThread0.irqThreadRdy = NiFpga_False;		// set flag to false, signals thread end
-	irq_status = pthread_join(thread, NULL);	// join threads
-	irq_status = Irq_UnregisterTimerIrq(&irqTimer0, irqThread0.irqContext);
+	rg_stop(&sched);
+	rg_print(&sched);
+	filter_close(&filter);
 
 	// Signal program end
 	printf_lcd("\fOff");
@@ -137,92 +153,101 @@ int main(int argc, char **argv){
 
 // Functions ###################################################################
 
-void* Timer_ISR(void *thread_resource){
-/* Description of Timer_ISR
- * This function implements a biquad cascade to calculate an output value given
- * an input value on a thread separate from main.
- * An rtc timer interrupt triggers every 0.5ms to signal that cascade() should be executed.
- * 500 inputs and outputs are saved to a matlab file.
- *
- * 1) initialize
- * 	a) cast thread resource
- * 	b) AIO
- * 	c) set analog output connector AOC1 to 0V.
- * 	d) initialize cascade parameters
- * 2) Loop while irqThreadRdy is true
- * 	a) wait for IRQ to assert, write time interval to IRQTIMERWRITE
- * 		write TRUE to IRQTIMERSETTIME
- * 	b) read analog input AIC0 for x(n) value
- * 	c) call cascade() to calculate y(n) via biquad cascade
- * 	d) send y(n) to AOC1
- * 	e) Acknowledge interrupt
- * 3)Save 500 point response buffer to Lab6.mat file
+void filter_open(Filter_Task *f){
+/* Description of filter_open
+ * Sets up what filter_tick() uses, before the scheduler starts.
+ * 	a) AIO
+ * 	b) set analog output AOC1 to 0V.
+ * 	c) initialize cascade parameters, one channel per input (bq_multi_set())
+ * 	d) capture file for the telemetry stream
  */
-
-	// 1) Initialize: cast input resource
-	ThreadResource *threadResource = (ThreadResource*) thread_resource;
-
-	// variable declarations
-	double v_in;
-	double v_out;	// (volts)
-
-	// matlab requirements
-	static double buffer1[IMAX];	//v_in
-	static double buffer2[IMAX];	//v_out
-	static double *bp_in = buffer1;	//buffer pointer
-	static double *bp_out = buffer2;	//buffer pointer
+	int ch;
 
 	// initialize analog i/o, connector C
-	MyRio_Aio AIC0;		// C, analog input 0
-	MyRio_Aio AOC1;		// C, analog output 1
-	Aio_InitCI0(&AIC0);	// initialize i0
-	Aio_InitCO1(&AOC1);	// initialize o1
-
-	Aio_Write(&AOC1, 0);// start at 0V output
+	Aio_InitCI0(&f->AIC0);	// initialize i0
+	Aio_InitCI1(&f->AIC1);	// initialize i1
+	Aio_InitCO1(&f->AOC1);	// initialize o1
+
+	io_tx_init(&f->io);
+	f->ai[0] = io_tx_ai(&f->io, &f->AIC0);
+	f->ai[1] = io_tx_ai(&f->io, &f->AIC1);
+	f->ao = io_tx_ao(&f->io, &f->AOC1, 0);	// start at 0V output
 	// voltage is maintained until updated with another Aio_Write()
 
 	// set cascade() parameters
 	double v_min = -10;	// minimum saturation voltage (v)
 	double v_max = 10;	// maximum saturation voltage (v)
 	int myFilter_ns = 2;			// # of biquad sections
-	uint32_t timeoutValue = 500;	// T - us; f_s = 2000 Hz, (500=0.5ms)
 	static struct biquad myFilter[] = {
 	  {1.0000e+00,  9.9999e-01, 0.0000e+00,
 	   1.0000e+00, -8.8177e-01, 0.0000e+00, 0, 0, 0, 0, 0},
 	  {2.1878e-04,  4.3755e-04, 2.1878e-04,
 	   1.0000e+00, -1.8674e+00, 8.8220e-01, 0, 0, 0, 0, 0}
 	};
+	// same filter as cascade(myFilter) on every channel, a0 divided out
+	// once here (biquad.c)
+	bq_multi_init(&f->filter, NCH, myFilter_ns, v_min, v_max);
+	for (ch = 0; ch < NCH; ch++) bq_multi_set(&f->filter, ch, myFilter, myFilter_ns);
+
+	// matlab buffers and capture file
+	f->n = 0;
+	static const char *const cap_names[2*NCH] = {"vin0", "vout0", "vin1", "vout1"};
+	static const uint32_t cap_types[2*NCH] = {CAP_F32, CAP_F32, CAP_F32, CAP_F32};
+	if (cap_open(&f->cap, "Lab6_trenton.cap", 2*NCH, cap_names, cap_types) < 0
+			|| cap_telem(&f->tlm, &f->cap) < 0) printf("Can't open capture file\n");
+}
 
-	// 2) while loop to process interrupts, checks irqThreadRdy -----------------
-	while (threadResource->irqThreadRdy == NiFpga_True){
-		//wait for interrupt
-		uint32_t irqAssert = 0;
-		Irq_Wait(threadResource->irqContext,
-				TIMERIRQNO,
-				&irqAssert,
-				(NiFpga_Bool*)&(threadResource->irqThreadRdy));
-		// check for timer IRQ assert
-		if (irqAssert & (1<<TIMERIRQNO)){
-			// Schedule next interrupt
-			NiFpga_WriteU32(myrio_session, IRQTIMERWRITE, timeoutValue);
-			NiFpga_WriteBool(myrio_session, IRQTIMERSETTIME, NiFpga_True);
-
-			//ISR service code --------------------------------------------------
-			v_in = Aio_Read(&AIC0);	// Analog input voltage reading (volts)
-			// run cascade() to calculate y(n), aka v_out
-			v_out = cascade( v_in, myFilter, myFilter_ns, v_min, v_max);
-			Aio_Write(&AOC1, v_out);	// write A0 voltage
-
-			// matlab buffer
-			if (bp_in < buffer1 + IMAX) {
-					*bp_in++ = v_in;
-					*bp_out++ = v_out;
-				}
-
-
-			Irq_Acknowledge(irqAssert);	// acknowledge interrupt
-		}
+void filter_tick(void *task){
+/* Description of filter_tick
+ * This function implements a biquad cascade to calculate an output value given
+ * an input value. The rate group scheduler (rategrp.c) calls it on the ISR
+ * thread every 0.5ms timer tick, after it has re-armed the timer and
+ * before it acknowledges the interrupt.
+ * 500 inputs and outputs are kept for a matlab file.
+ *
+ * 	a) read analog inputs AIC0 and AIC1 for x(n) values
+ * 	b) call bq_multi_run() to calculate y(n) for both channels at once
+ * 	c) send channel 0's y(n) to AOC1, channel 1's only goes to the telemetry
+ * The analog channels are read and written through an Io_Tx (regio.c),
+ * one input phase and one output phase per tick.
+ * More inputs only take more channels in the Bq_Multi, they are filtered
+ * in the same call, BQ_LANES at a time.
+ * Every tick's inputs and outputs are also pushed to a telemetry stream
+ * (telem.c), which a writer thread saves to the capture file
+ * Lab6_trenton.cap (capture.c) for as long as the program runs.
+ * tools/cap2mat converts it to a mat file.
+ */
+	Filter_Task *f = (Filter_Task*) task;
+	double rec[2*NCH];
+	int ch;
+
+	io_tx_read(&f->io);
+	for (ch = 0; ch < NCH; ch++) f->filter.x[ch] = f->io.vin[f->ai[ch]];	// volts
+	// run the cascades to calculate y(n), aka v_out
+	bq_multi_run(&f->filter);
+	f->io.vout[f->ao] = f->filter.y[0];
+	io_tx_write(&f->io);	// write AO voltage
+
+	// matlab buffer, AIC0 -> AOC1
+	if (f->n < IMAX){
+		f->buffer1[f->n] = f->filter.x[0];
+		f->buffer2[f->n++] = f->filter.y[0];
 	}
+	for (ch = 0; ch < NCH; ch++){
+		rec[2*ch] = f->filter.x[ch];
+		rec[2*ch+1] = f->filter.y[ch];
+	}
+	telem_push(&f->tlm, timing_now(), rec);	// no file i/o here
+}
+
+void filter_close(Filter_Task *f){
+/* Description of filter_close
+ * After the scheduler has stopped: save the 500 point response buffer to
+ * Lab6_trenton_sine.mat, close the capture and set the outputs to 0V.
+ */
+	// the capture first, its writer thread has nothing left to wait for
+	if (telem_close(&f->tlm) < 0) printf("telemetry write failed\n");
+	if (telem_dropped(&f->tlm)) printf("telemetry dropped %u\n", telem_dropped(&f->tlm));
 
 	//save matlab file
 	int err=101;			// Error code
@@ -230,46 +255,9 @@ void* Timer_ISR(void *thread_resource){
 	mf = openmatfile("Lab6_trenton_sine.mat", &err);	// open file
 	if(!mf) printf("Can't open mat file %d\n", err);
 	matfile_addstring(mf, "myName", "Trenton Fletcher");
-	matfile_addmatrix(mf, "vin", buffer1, IMAX, 1, 0);
-	matfile_addmatrix(mf, "vout", buffer2, IMAX, 1, 0);
+	matfile_addmatrix(mf, "vin", f->buffer1, IMAX, 1, 0);
+	matfile_addmatrix(mf, "vout", f->buffer2, IMAX, 1, 0);
 	matfile_close(mf);		// close file
 
-	Aio_Write(&AOC1, 0);// for safety, set output voltage to 0 volts
-	pthread_exit(NULL); // exit thread
-	return NULL;
+	Aio_Write(&f->AOC1, 0);// for safety, set output voltage to 0 volts
 }
-
-double cascade(double xin, struct biquad *fa, int ns, double ymin, double ymax){
-/*
- * Cascade() takes an input value, saturation values,
- * 	an array of biquad structures, and the number of biquads in the array.
- * xin is the measured analog voltage from the C connector
- * A difference equation is computed for each biquad, with the outputs
- * 	of the previous biquad passing to the next, and so on.
- * A calculated y0 is returned from the function.
- */
-	struct biquad *f = fa; 	// f, pointer to biquad struct
-	double y0 = xin; 		// initial input voltage
-
-	// loop through ns biquads
-	int i;
-	for (i=0; i < ns; i++){
-		// assign previous output to current input
-		f->x0 = y0;
-
-		// difference equation
-		y0 = ((f->b0 * f->x0)+(f->b1 * f->x1)+(f->b2 * f->x2)-(f->a1 * f->y1)-(f->a2 * f->y2)) / (f->a0);
-
-		// update previous values of x and y
-		f->x2 = f->x1; f->x1 = f->x0;
-		f->y2 = f->y1; f->y1 = y0;
-
-		// increment pointer to next biquad struct in array
-		f++;
-	}
-
-	y0 = SATURATE(y0, ymin, ymax); 	// saturate final y0
-	return y0;						// return final output value
-}
-
-
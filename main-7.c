@@ -4,10 +4,10 @@
  * Date: 03/14/25
  * Description: The purpose of this code is to implement PI control of
  * a DC motor. This is implemented by a timer based interrupt system,
- * ctable2() which allows a user to edit the gains of the system, and
+ * ptable_edit() which allows a user to edit the gains of the system, and
  * biquad cascade for the PI calculations. vel() provides rpm calculations
  * to the readout. Program configurations can be changed while the program
- * is running thanks to ctable2() running on a separate thread. The table
+ * is running thanks to ptable_edit() running on a separate thread. The table
  * is shared between threads. 250 data points for each reference velocity
  * are saved to a .mat file for analysis.
  */
@@ -21,27 +21,26 @@
 #include <pthread.h>	// linux multithreading
 #include "TimerIRQ.h"	// timer irq for interrupt method
 #include "matlabfiles.h"// matlab file creation
-#include "ctable2.h"	// ctable2 for editing values
+#include "ctable2.h"	// table entries, as used by ctable2
 #include "Encoder.h"	// quadrature encoder
+#include "regio.h"		// grouped register i/o for the ISR
+#include "biquad.h"		// biquad cascade filters
+#include "ptable.h"		// table editor with a version counter
+#include "keypad.h"		// scanned keypad with debounced key events
+#include "telem.h"		// telemetry stream to disk
+#include "capture.h"	// columnar capture file
+#include "timing.h"		// time stamps
+#include "istat.h"		// IRQ latency and service time
+#include "rtthread.h"	// real time ISR thread
 
 //#include "emulate.h"	// motor emulation
 
-// saturation macro for cascade(), provided by book
-#define SATURATE(x,lo,hi) ((x) < (lo) ? (lo) : (x) > (hi) ? (hi) : (x))
 #define IMAX 250 //matlab data points
 #define M_PI 3.14159265358979323846 // PI DAY
 
-/* biquad structure for cascade()*/
-struct biquad {
-  double b0; double b1; double b2;   // numerator
-  double a0; double a1; double a2;   // denominator
-  double x0; double x1; double x2;   // input
-  double y1; double y2;              // output
-};
-
 /* prototypes */ //--------------------------------------------------------
 
-double vel(void);	// velocity calculation
+double vel(uint32_t Cn);	// velocity calculation
 
 /* ctable2
 int ctable2(char *title,
@@ -51,13 +50,6 @@ int ctable2(char *title,
 // ISR and interrupt scheduler
 void* Timer_ISR(void *thread_resource);
 
-// biquad cascade implementation
-double cascade(double xin,         // input
-               struct biquad *fa,  // biquad array
-               int    ns,          // no. segments
-               double ymin,        // min output
-               double ymax);       // max output
-
 //encoder prototypes
 NiFpga_Status EncoderC_initialize(NiFpga_Session myrio_session,
 		MyRio_Encoder *channel);	// Encoder initialize
@@ -71,8 +63,9 @@ MyRio_Encoder encC0; // channel encC0
 //Globally defined thread resource structure
 typedef struct {
   NiFpga_IrqContext irqContext;  // context
-  table *a_table;                // table
+  Ptable *params;                // table and its version
   NiFpga_Bool irqThreadRdy;      // ready flag
+  Istat stat;                    // wake-up latency, service time
 } ThreadResource;
 
 /*//ctable2 structure in ctable2.h
@@ -88,10 +81,10 @@ NiFpga_Session myrio_session;// myrio session macro required for book code templ
 int main(int argc, char **argv){
 /* Description of main()
  * Initialize myrio, table editor variables, and timer thread.
- * Calls ctable2. When "<-" is pressed, ctable2 returns and main continues.
+ * Calls ptable_edit(). When "<-" is pressed, it returns and main continues.
  * Cleans up threads and ends myrio session.
  *
- * ctable is a shared table between the timer ISR and ctable2().
+ * ctable is a shared table between the timer ISR and ptable_edit().
  * It can be updated while the ISR is running and its changes are reflected
  *  in the next iteration of the ISR. It's used to control proportional and
  *  integral gain constants, as well as reference velocity and BTI.
@@ -112,6 +105,8 @@ int main(int argc, char **argv){
 	  {"BTI: ms  ", 1, 5}		// 5 ms
 	};
 	int nval = 6; // number of table parameters
+	Ptable params;	// the table and the version ptable_edit() bumps
+	ptable_init(&params, my_table, nval);
 
 	// configure timer interrupt and create timer thread ----------------------
 	int32_t irq_status;
@@ -126,19 +121,32 @@ int main(int argc, char **argv){
 										&irqThread0.irqContext,
 										timeoutValue);
 	// point to table
-	irqThread0.a_table = my_table;
+	irqThread0.params = &params;
 	// set indicator to allow new thread
 	irqThread0.irqThreadRdy = NiFpga_True;
-	// create thread calling Timer_ISR()
-	irq_status = pthread_create(&thread, NULL, Timer_ISR, &irqThread0);
+	istat_init(&irqThread0.stat, "Timer IRQ");
+	// create thread calling Timer_ISR(), real time priority on its own core
+	Rt_Attr rt = RT_ATTR_ISR;
+	Rt_Status rt_status;
+	irq_status = rt_thread_create(&thread, &rt, Timer_ISR, &irqThread0, &rt_status);
+	if (irq_status != 0){
+		printf("Can't start Timer_ISR (%d)\n", (int)irq_status);
+		Irq_UnregisterTimerIrq(&irqTimer0, irqThread0.irqContext);
+		MyRio_Close();
+		return irq_status;
+	}
+	rt_report("Timer_ISR", &rt, &rt_status);
 
-	// call ctable2
-	ctable2(Table_Title, my_table, nval); // returns 0 when "<-" pressed
+	// edit the table
+	keypad_start(KEYPAD_SCAN_NS);
+	ptable_edit(Table_Title, &params); // returns 0 when "<-" pressed
+	keypad_stop();
 
 	// ) Terminate ISR and unregister interrupt -----------------------------
 	irqThread0.irqThreadRdy = NiFpga_False;		// set flag to false, signals thread end
 	irq_status = pthread_join(thread, NULL);	// join threads
 	irq_status = Irq_UnregisterTimerIrq(&irqTimer0, irqThread0.irqContext);
+	istat_print(&irqThread0.stat);
 
 	// ) MyRio session close - required by hardware ---------------------------
 	status = MyRio_Close();						// close FPGA session
@@ -152,9 +160,29 @@ void* Timer_ISR(void *thread_resource){
  * This function schedules timed interrupts and initializes the motor encoder
  * and AIO, calls vel() for velocity and implements the PI control law by
  * computing current error between reference and actual speed, then calls
- * cascade() to compute the control value. This value is sent to the motor
+ * bq_cascade() to compute the control value. This value is sent to the motor
  * and the table is updated with all appropriate values.
  *
+ * The encoder and DAC go through an Io_Tx (regio.c): the encoder is read
+ * once at the start of the tick and the DAC written once at the end.
+ * The PI biquad runs as a Bq_Cascade (biquad.c). b0, b1 and the BTI
+ * scale factors only change when the table is edited, so they are rebuilt
+ * when the table's version changes instead of every tick. New gains go in
+ * with bq_retune(), which keeps the integrator where it is.
+ *
+ * The ISR works on its own copy of the table (a Ptable_Snap). Each tick
+ * takes one consistent snapshot of V_R, Kp, Ki and BTI from the editor,
+ * or keeps the last one if an edit is being stored right then, and V_J
+ * and VDAout go back with ptable_report(). Neither call ever waits for
+ * the editor thread.
+ *
+ * V_R, V_J and the DAC voltage also go to a telemetry stream every tick
+ * (telem.c), saved to the capture file Lab7_trenton.cap (capture.c) by a
+ * writer thread for the whole run, not just the 250 points after the last
+ * V_R change. tools/cap2mat converts it to a mat file.
+ *
+ * Each tick's wake-up latency and service time go into the histograms in
+ * threadResource->stat (istat.c), printed when the program ends.
  */
 
 	// 1) Initialize Everything: cast input resource
@@ -164,13 +192,25 @@ void* Timer_ISR(void *thread_resource){
 	double V_out;
 	double speed_error;
 
+	// this thread's copy of the table, see ptable.h
+	Ptable *params = threadResource->params;
+	Ptable_Snap par;
+	while (!ptable_snapshot(params, &par)){}	// first copy, before any tick
+
 	// variable names for table entries
-	double *Omega_R = &((threadResource->a_table + 0)-> value);
-	double *Omega_J = &((threadResource->a_table + 1)-> value);
-	double *VDA_out = &((threadResource->a_table + 2)-> value);
-	double *Kp = &((threadResource->a_table + 3)-> value);
-	double *Ki = &((threadResource->a_table + 4)-> value);
-	double *BTI = &((threadResource->a_table + 5)-> value);
+	double *Omega_R = &par.value[0];
+	double *Omega_J = &par.value[1];
+	double *VDA_out = &par.value[2];
+	double *Kp = &par.value[3];
+	double *Ki = &par.value[4];
+	double *BTI = &par.value[5];
+
+	// values derived from the table, rebuilt when its version changes
+	uint32_t version = par.version - 1;	// build on the first tick
+	double bti_s = 0;			// BTI (s)
+	uint32_t bti_us = 0;		// BTI (us), timer period
+	double rpm_per_count = 0;	// rpm for one encoder count per BTI
+	double e1 = 0, e2 = 0;		// last two speed errors, for bq_retune()
 
 	// set cascade() parameters
 	double v_min = -10;	// minimum saturation voltage (v)
@@ -181,6 +221,8 @@ void* Timer_ISR(void *thread_resource){
 		  {0.0000e+00,  0.0000e+00, 0.0000e+00,
 		   1.0000e+00, -1.0000e+00, 0.0000e+00, 0, 0, 0, 0, 0},
 	};
+	static Bq_Cascade pi;	// normalized copy of myFilter that runs each tick
+	bq_init(&pi, myFilter, myFilter_ns, v_min, v_max);
 
 	// Initialize Encoder interface
 	EncoderC_initialize(myrio_session, &encC0);
@@ -189,7 +231,10 @@ void* Timer_ISR(void *thread_resource){
 	MyRio_Aio AOC0;		// C, analog output 1
 	Aio_InitCO1(&AOC0);	// initialize o1
 
-	Aio_Write(&AOC0, 0);// start at 0V output
+	Io_Tx io;			// channels read and written each tick
+	io_tx_init(&io);
+	int enc = io_tx_encoder(&io, &encC0);
+	int ao = io_tx_ao(&io, &AOC0, 0);	// start at 0V output
 	// Note: voltage is maintained until updated with another Aio_Write()
 
 	// MATLAB VARIABLES
@@ -204,15 +249,22 @@ void* Timer_ISR(void *thread_resource){
 	double Omega_init = 0;	// initial Omega_R value
 	static double *bp_oj = Omega_J_buf;
 	static double *bp_vda = VDA_out_buf;
+	static Telem tlm;			// V_R, V_J (rpm), V_out (V) every tick
+	static Capture cap;			// where tlm goes
+	static const char *const cap_names[3] = {"Omega_R", "Omega_J", "VDA_Out"};
+	static const uint32_t cap_types[3] = {CAP_F64, CAP_F64, CAP_F64};
+	double rec[3];
+	if (cap_open(&cap, "Lab7_trenton.cap", 3, cap_names, cap_types) < 0
+			|| cap_telem(&tlm, &cap) < 0) printf("Can't open capture file\n");
 
 	// 2) while loop to process interrupts, checks irqThreadRdy -----------------
 	while (threadResource->irqThreadRdy == NiFpga_True){
 	/* timer loop
-	 * 2.1) schedule interrupt
+	 * 2.1) if the table changed: compute ai, bi from Kp, Ki, retune the
+	 * 	biquad and the BTI scale factors. schedule interrupt
 	 * 2.2) vel()
-	 * 2.3) compute ai, bi from Kp, Ki, update biquad
 	 * 2.4) omega_ref-omega_actual
-	 * 2.5) cascade() with 10v saturation
+	 * 2.5) bq_cascade() with 10v saturation
 	 * 2.6) AOC0 output
 	 * 2.7) update table
 	 * 2.8) save results to matlab
@@ -226,31 +278,45 @@ void* Timer_ISR(void *thread_resource){
 				(NiFpga_Bool*)&(threadResource->irqThreadRdy));
 		// check for timer IRQ assert
 		if (irqAssert & (1<<TIMERIRQNO)){
-			// 2.1) Schedule next interrupt
+			istat_wake(&threadResource->stat);
+			// 2.1) rebuild what depends on the table, if it was edited
+			ptable_snapshot(params, &par);	// keeps the last copy if mid-edit
+			if (par.version != version){
+				version = par.version;
+				bti_s = *BTI/1000;
+				bti_us = *BTI*1000;
+				rpm_per_count = 60/(2048.0 * bti_s);
+				// 2.3) compute ai, bi from Kp, Ki and update biquad
+				myFilter->b0 = *Kp + (*Ki*bti_s/2);
+				myFilter->b1 = -*Kp + (*Ki*bti_s/2);
+				bq_retune(&pi, 0, myFilter, e1, e2);
+			}
+			// Schedule next interrupt
 			//NiFpga_WriteU32(myrio_session, IRQTIMERWRITE, timeoutValue);
-			NiFpga_WriteU32(myrio_session, IRQTIMERWRITE, (*BTI*1000));
+			istat_assert(&threadResource->stat, timing_now() + bti_us*TIMING_NS_PER_US);
+			io_tx_timer(&io, bti_us);
 			//Note: bti from table controls wait time between timed interrupts
-			NiFpga_WriteBool(myrio_session, IRQTIMERSETTIME, NiFpga_True);
 
 			//ISR service code --------------------------------------------------
+			io_tx_read(&io);	// encoder count
 			// 2.2) call vel
-			*Omega_J = (vel() * 60)/(2048.0 * (*BTI/1000)); // rpm
-
-			// 2.3) compute ai, bi from Kp, Ki and update biquad
-			myFilter->b0 = *Kp + (*Ki*(*BTI/1000)/2);
-			myFilter->b1 = -*Kp + (*Ki*(*BTI/1000)/2);
+			*Omega_J = vel(io.count[enc]) * rpm_per_count; // rpm
 
 			// 2.4) computer current error
 			speed_error = (*Omega_R - *Omega_J)*2*M_PI/60;	// rad/s
+			e2 = e1;
+			e1 = speed_error;
 
-			// 2.5) call cascade() to calculate y(n), aka v_out
-			V_out = cascade(speed_error, myFilter, myFilter_ns, v_min, v_max); // volts
+			// 2.5) run the cascade to calculate y(n), aka v_out
+			V_out = bq_cascade(&pi, speed_error); // volts
 
 			// 2.6) send control voltage value to DAC
-			Aio_Write(&AOC0, V_out);
+			io.vout[ao] = V_out;
+			io_tx_write(&io);
 
 			// 2.7) update table values
 			*VDA_out = V_out * 1000;	// V to mV
+			ptable_report(params, &par);	// V_J and VDAout to the display
 
 			// 2.8) MATLAB data
 				// save speed and output voltage to buffer if not full
@@ -258,6 +324,10 @@ void* Timer_ISR(void *thread_resource){
 				*bp_oj++ = *Omega_J;
 				*bp_vda++ = V_out;
 			}
+			rec[0] = *Omega_R;
+			rec[1] = *Omega_J;
+			rec[2] = V_out;
+			telem_push(&tlm, timing_now(), rec);	// no file i/o here
 				// handle a change in reference velocity
 			if (Omega_init != *Omega_R){
 				bp_oj = Omega_J_buf;		// reset index
@@ -271,6 +341,7 @@ void* Timer_ISR(void *thread_resource){
 			}
 
 			// 2.9) acknowledge interrupt
+			istat_ack(&threadResource->stat);
 			Irq_Acknowledge(irqAssert);
 		}
 	}
@@ -288,6 +359,8 @@ void* Timer_ISR(void *thread_resource){
 	matfile_addmatrix(mf, "Kp", &Kp_mat, 1, 1, 0);
 	matfile_addmatrix(mf, "Ki", &Ki_mat, 1, 1, 0);
 	matfile_close(mf);
+	if (telem_close(&tlm) < 0) printf("telemetry write failed\n");
+	if (telem_dropped(&tlm)) printf("telemetry dropped %u\n", telem_dropped(&tlm));
 
 	// terminate thread
 	Aio_Write(&AOC0, 0);// for safety, set output voltage to 0 volts
@@ -296,18 +369,16 @@ void* Timer_ISR(void *thread_resource){
 }
 
 // Functions from previous labs ########################################
-double vel(void){
-/* measures velocity (BDI/BTI) by reading current encoder count,
+double vel(uint32_t Cn){
+/* measures velocity (BDI/BTI) from the current encoder count Cn,
  * taking the difference between the previous count,
  * returns the double speed (BDI/BTI)
  */
 	// function variables
 	static int i_vel=0; //flag to check if first vel call
-	static uint32_t Cn; // current encoder counter
 	static uint32_t Cn1; // previous encoder count
 	double speed; // speed, units of BDI/BTI
 
-	Cn = Encoder_Counter(&encC0); // get encoder count
 	// Check if first call to vel
 	if (i_vel==0){
 		Cn1 = Cn; // only on first call set Cn1 to Cn
@@ -317,32 +388,3 @@ double vel(void){
 	Cn1 = Cn; // update previous count
 	return speed;
 }
-
-double cascade(double xin, struct biquad *fa, int ns, double ymin, double ymax){
-/*
- * Cascade() takes an input value, saturation values,
- * 	an array of biquad structures, and the number of biquads in the array.
- * xin is the measured analog voltage from the C connector
- * A difference equation is computed for each biquad, with the outputs
- * 	of the previous biquad passing to the next, and so on.
- * A calculated y0 is returned from the function.
- */
-	struct biquad *f = fa; 	// f, pointer to biquad struct
-	double y0 = xin; 		// initial input voltage
-	// loop through ns biquads
-	int i;
-	for (i=0; i < ns; i++){
-		// assign previous output to current input
-		f->x0 = y0;
-		// difference equation
-		y0 = ((f->b0 * f->x0)+(f->b1 * f->x1)+(f->b2 * f->x2)-(f->a1 * f->y1)-(f->a2 * f->y2)) / (f->a0);
-		// update previous values of x and y
-		f->x2 = f->x1; f->x1 = f->x0;
-		f->y2 = f->y1; f->y1 = y0;
-		// increment pointer to next biquad struct in array
-		f++;
-	}
-	y0 = SATURATE(y0, ymin, ymax); 	// saturate final y0
-	return y0;						// return final output value
-}
-
@@ -0,0 +1,240 @@
+/*
+ * matstream.c
+ * Author: Trenton
+ * Date: 06/20/25
+ * Description: Streaming MAT-file writer, see matstream.h.
+ * Same layout as matlabfiles.c: a 128 byte header, then one miMATRIX
+ * element per variable (array flags, dimensions, name, real part), every
+ * sub-element padded to 8 bytes. An open variable is written with zero
+ * sizes, which mats_end() and mats_sync() fill in. Those fields are at
+ * 4 byte offsets and the buffer is always written at multiples of
+ * MATS_BUF, so a field is either all in the buffer or all in the file.
+ */
+
+/* includes */
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "matstream.h"
+
+/* definitions */
+#define miINT8   1
+#define miUINT16 4
+#define miINT32  5
+#define miUINT32 6
+#define miDOUBLE 9
+#define miMATRIX 14
+#define mxCHAR_CLASS   4
+#define mxDOUBLE_CLASS 6
+#define DIMS 32				// dims from the miMATRIX tag (bytes)
+
+/* prototypes */
+static int put(Mat_Stream *m, const void *p, uint32_t n);
+
+// Functions ###################################################################
+
+static uint32_t padded(uint32_t nbytes){
+	return (nbytes + 7) & ~7u;
+}
+
+static int flush_buf(Mat_Stream *m){
+/* the full buffer at pos, which is where the file offset is */
+	int off = 0, w;
+	while (off < m->nbuf){
+		w = write(m->fd, m->buf + off, m->nbuf - off);
+		if (w < 0) return -1;
+		off += w;
+	}
+	m->pos += m->nbuf;
+	m->nbuf = 0;
+	return 0;
+}
+
+static int put(Mat_Stream *m, const void *p, uint32_t n){
+	const uint8_t *b = p;
+	uint32_t k;
+	while (n > 0){
+		k = MATS_BUF - m->nbuf;
+		if (k > n) k = n;
+		memcpy(m->buf + m->nbuf, b, k);
+		m->nbuf += k;
+		b += k;
+		n -= k;
+		if (m->nbuf == MATS_BUF && flush_buf(m) < 0){
+			m->error = 1;
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int put_tag(Mat_Stream *m, uint32_t type, uint32_t nbytes){
+	uint32_t tag[2] = {type, nbytes};
+	return put(m, tag, 8);
+}
+
+static int put_pad(Mat_Stream *m, uint32_t nbytes){
+	static const uint8_t zero[8] = {0};
+	return put(m, zero, padded(nbytes) - nbytes);
+}
+
+static uint32_t put_header(Mat_Stream *m, const char *name, uint32_t cls,
+		int32_t rows, int32_t cols, uint32_t data_bytes){
+/* miMATRIX tag through the name, returns the bytes up to the data */
+	uint32_t len = (uint32_t)strlen(name);
+	uint32_t flags[2] = {cls, 0};
+	int32_t dims[2] = {rows, cols};
+	uint32_t head = 8 + 16 + 16 + 8 + padded(len) + 8;
+
+	put_tag(m, miMATRIX, head - 8 + padded(data_bytes));
+	put_tag(m, miUINT32, 8);
+	put(m, flags, 8);
+	put_tag(m, miINT32, 8);
+	put(m, dims, 8);
+	put_tag(m, miINT8, len);
+	put(m, name, len);
+	put_pad(m, len);
+	return head;
+}
+
+static int patch(Mat_Stream *m, uint64_t off, uint32_t v){
+/* a 4 byte field already written, in the buffer or in the file */
+	if (off >= m->pos){
+		memcpy(m->buf + (off - m->pos), &v, 4);
+		return 0;
+	}
+	return pwrite(m->fd, &v, 4, off) == 4 ? 0 : -1;
+}
+
+static int put_sizes(Mat_Stream *m){
+/* the open variable's sizes as of now */
+	uint32_t data = 8 * (uint32_t)m->rows * m->cols;
+	int s = 0;
+	s |= patch(m, m->var + 4, m->head - 8 + data);
+	if (m->rows == 1){
+		s |= patch(m, m->var + DIMS, m->cols);		// column vector
+		s |= patch(m, m->var + DIMS + 4, 1);
+	}
+	else s |= patch(m, m->var + DIMS + 4, m->cols);
+	s |= patch(m, m->var + m->head - 4, data);
+	if (s) m->error = 1;
+	return s;
+}
+
+int mats_open(Mat_Stream *m, const char *file){
+	char text[116];
+	uint8_t tail[12] = {0};
+	m->fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (m->fd < 0) return -1;
+	m->error = 0;
+	m->pos = 0;
+	m->nbuf = 0;
+	m->open = 0;
+	m->sync = 0;
+	memset(text, ' ', sizeof(text));
+	memcpy(text, "MATLAB 5.0 MAT-file, myRIO stream", 33);
+	put(m, text, sizeof(text));
+	tail[8] = 0x00; tail[9] = 0x01;		// version 0x0100
+	tail[10] = 'I'; tail[11] = 'M';		// little endian
+	put(m, tail, sizeof(tail));
+	return 0;
+}
+
+int mats_string(Mat_Stream *m, const char *name, const char *str){
+	uint32_t n = (uint32_t)strlen(str);
+	uint32_t i;
+	uint16_t c;
+	if (m->open) return -1;
+	put_header(m, name, mxCHAR_CLASS, 1, (int32_t)n, 2*n);
+	put_tag(m, miUINT16, 2*n);
+	for (i = 0; i < n; i++){
+		c = (uint8_t)str[i];
+		put(m, &c, 2);
+	}
+	put_pad(m, 2*n);
+	return m->error ? -1 : 0;
+}
+
+int mats_matrix(Mat_Stream *m, const char *name, const double *v, int rows, int cols){
+	uint32_t nbytes = 8 * (uint32_t)rows * (uint32_t)cols;
+	if (m->open) return -1;
+	put_header(m, name, mxDOUBLE_CLASS, rows, cols, nbytes);
+	put_tag(m, miDOUBLE, nbytes);
+	put(m, v, nbytes);
+	return m->error ? -1 : 0;
+}
+
+int mats_begin(Mat_Stream *m, const char *name, int rows){
+/* header with no columns yet, the sizes come later */
+	if (m->open || rows < 1) return -1;
+	m->var = m->pos + m->nbuf;
+	m->rows = rows;
+	m->cols = 0;
+	m->head = put_header(m, name, mxDOUBLE_CLASS, rows == 1 ? 0 : rows, rows == 1, 0);
+	put_tag(m, miDOUBLE, 0);
+	m->open = 1;
+	return m->error ? -1 : 0;
+}
+
+int mats_append(Mat_Stream *m, const double *v, int ncol){
+	uint64_t data = 8 * (uint64_t)m->rows * (m->cols + (uint64_t)ncol);
+	if (!m->open || m->error) return -1;
+	if (m->head - 8 + data > UINT32_MAX){	// element size is 32 bits
+		m->error = 1;
+		return -1;
+	}
+	if (put(m, v, 8 * (uint32_t)m->rows * ncol) < 0) return -1;
+	m->cols += ncol;
+	return 0;
+}
+
+int mats_end(Mat_Stream *m){
+	if (!m->open) return -1;
+	put_sizes(m);
+	m->open = 0;
+	return m->error ? -1 : 0;
+}
+
+int mats_sync(Mat_Stream *m){
+/* the tail of the file from the buffer, the buffer is kept and written
+ * again as a whole when it fills, so writes stay aligned */
+	if (m->open) put_sizes(m);
+	if (pwrite(m->fd, m->buf, m->nbuf, m->pos) != m->nbuf) m->error = 1;
+	return m->error ? -1 : 0;
+}
+
+int mats_close(Mat_Stream *m){
+	if (m->open) mats_end(m);
+	if (flush_buf(m) < 0) m->error = 1;
+	if (close(m->fd) < 0) m->error = 1;
+	return m->error ? -1 : 0;
+}
+
+/* telemetry sink -----------------------------------------------------------*/
+static int telem_write(void *ctx, const Telem_Rec *r, int n){
+/* one column per record, time in seconds first */
+	Mat_Stream *m = ctx;
+	double col[TELEM_MAXCH + 1];
+	int i;
+	for (i = 0; i < n; i++){
+		col[0] = r[i].t * 1e-9;
+		memcpy(col + 1, r[i].v, 8 * (m->rows - 1));
+		if (mats_append(m, col, 1) < 0) return -1;
+	}
+	if (n > 0 && r[n-1].t >= m->sync){
+		m->sync = r[n-1].t + MATS_SYNC_NS;
+		return mats_sync(m);
+	}
+	return 0;
+}
+
+static int telem_close_mat(void *ctx){
+	return mats_close(ctx);
+}
+
+int mats_telem(Telem *t, Mat_Stream *m, const char *name, int nch){
+	if (nch < 1 || nch > TELEM_MAXCH) return -1;
+	if (mats_begin(m, name, nch + 1) < 0) return -1;
+	m->sync = 0;
+	return telem_start(t, nch, telem_write, telem_close_mat, m);
+}
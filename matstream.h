@@ -0,0 +1,68 @@
+/*
+ * matstream.h
+ * Author: Trenton
+ * Date: 06/20/25
+ * Description: Streaming MAT-file (level 5) writer.
+ * matfile_addmatrix() writes a whole matrix from memory, so a capture has
+ * to sit in RAM until the end of the run and is gone if the program dies
+ * first. Here a double variable is opened with mats_begin(), columns are
+ * added with mats_append() as they come, and mats_end() writes the final
+ * sizes into the variable's header. One variable is open at a time; whole
+ * matrices and strings can go before or after it.
+ *
+ * Everything goes through a MATS_BUF byte buffer, page aligned, that is
+ * written with one write() when full, so the file only ever sees whole
+ * aligned buffers. The sizes in an open variable's header are patched in
+ * the buffer if they are still there, with pwrite() if not. mats_sync()
+ * writes the sizes and the partly filled buffer (it stays in memory and is
+ * written again when full), so the file on disk is a valid MAT file up to
+ * the last sync.
+ *
+ * The variable is rows x columns, column major like MATLAB: mats_append()
+ * adds whole columns of rows values. A single row stream is saved as a
+ * column vector (count x 1), like the labs' buffers.
+ *
+ * mats_telem() makes the open file the sink of a telemetry stream
+ * (telem.h): each record becomes a column [t (s); v[0..nch-1]], synced
+ * every MATS_SYNC_NS of record time, and telem_close() ends the variable
+ * and closes the file.
+ */
+
+#ifndef MATSTREAM_H
+#define MATSTREAM_H
+
+#include <stdint.h>
+#include "telem.h"
+
+#define MATS_BUF 65536					// write buffer (bytes), multiple of 4096
+#define MATS_SYNC_NS 1000000000ULL		// telemetry sink syncs every 1 s
+
+typedef struct {
+	int fd;
+	int error;					// a write failed or a variable got too big
+	uint64_t pos;				// file offset of buf[0]
+	int nbuf;					// bytes in buf
+	// open variable
+	int open;
+	uint64_t var;				// file offset of its miMATRIX tag
+	uint32_t head;				// bytes from the tag to the first value
+	int32_t rows;
+	uint32_t cols;				// columns appended
+	// telemetry sink
+	uint64_t sync;				// record time of the next sync
+	_Alignas(4096) uint8_t buf[MATS_BUF];
+} Mat_Stream;
+
+int mats_open(Mat_Stream *m, const char *file);		// 0, or -1
+int mats_string(Mat_Stream *m, const char *name, const char *str);
+int mats_matrix(Mat_Stream *m, const char *name, const double *v, int rows, int cols);
+int mats_begin(Mat_Stream *m, const char *name, int rows);	// open a variable
+int mats_append(Mat_Stream *m, const double *v, int ncol);	// ncol columns, column major
+int mats_end(Mat_Stream *m);		// final sizes into the open variable
+int mats_sync(Mat_Stream *m);		// file readable up to here
+int mats_close(Mat_Stream *m);		// ends an open variable, 0 or -1
+
+/* telemetry sink, m open, variable name of nch+1 rows */
+int mats_telem(Telem *t, Mat_Stream *m, const char *name, int nch);
+
+#endif
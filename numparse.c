@@ -0,0 +1,120 @@
+/*
+ * numparse.c
+ * Author: Trenton
+ * Date: 05/09/25
+ * Description: Keypad number input, see numparse.h.
+ *
+ * num_double() divides the digit integer by an exact power of ten. Both
+ * are exact doubles while the integer is below 2^53 (every 15 digit
+ * input), so the one division gives the same correctly rounded result as
+ * sscanf("%lf"). Past that (some 16 to 18 digit inputs) the integer would
+ * be rounded before the division, so those go through strtod() instead.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include "MyRio.h"
+#include "T1.h"
+#include "numparse.h"
+
+/* definitions */
+#define NUM_BUF 40		// keypad input buffer, same as double_in()
+#define NUM_EXACT (1LL << 53)	// largest mant that is exact as a double
+
+// powers of ten, exact as int64_t and as double up to 10^18
+static const int64_t p10[NUM_MAX_DIGITS + 1] = {
+		1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL,
+		100000000LL, 1000000000LL, 10000000000LL, 100000000000LL,
+		1000000000000LL, 10000000000000LL, 100000000000000LL,
+		1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+		1000000000000000000LL
+};
+
+// Functions ###################################################################
+
+Num_Error num_parse(const char *s, Num_Value *v){
+/* one pass over s, v is only written for NUM_OK */
+	int64_t m = 0;
+	int neg = 0, radix = 0, digits = 0, frac = 0;
+	char c;
+
+	if (*s == '\0') return NUM_EMPTY;
+	if (*s == '-'){
+		neg = 1;
+		s++;
+	}
+	while ((c = *s++) != '\0'){
+		if (c >= '0' && c <= '9'){
+			if (++digits > NUM_MAX_DIGITS) return NUM_RANGE;
+			m = 10*m + (c - '0');
+			frac += radix;
+		}
+		else if (c == '.'){
+			if (radix) return NUM_RADIX;
+			radix = 1;
+		}
+		else if (c == '-') return NUM_SIGN;
+		else return NUM_BADKEY;
+	}
+	if (digits == 0) return NUM_NODIGITS;
+	v->mant = neg ? -m : m;
+	v->frac = frac;
+	return NUM_OK;
+}
+
+double num_double(const Num_Value *v){
+	char s[32];
+	if (v->mant <= NUM_EXACT && v->mant >= -NUM_EXACT){
+		return (double)v->mant / (double)p10[v->frac];
+	}
+	snprintf(s, sizeof(s), "%lldE-%d", (long long)v->mant, v->frac);
+	return strtod(s, NULL);
+}
+
+int64_t num_int(const Num_Value *v){
+	return v->mant / p10[v->frac];	// C division truncates toward zero
+}
+
+int64_t num_fixed(const Num_Value *v, int places){
+/* saturates at the int64_t limits if places is too large for the value */
+	int64_t k;
+	if (places <= v->frac) return v->mant / p10[v->frac - places];
+	if (places - v->frac > NUM_MAX_DIGITS) return v->mant < 0 ? INT64_MIN : v->mant > 0 ? INT64_MAX : 0;
+	k = p10[places - v->frac];
+	if (v->mant > INT64_MAX / k) return INT64_MAX;
+	if (v->mant < INT64_MIN / k) return INT64_MIN;
+	return v->mant * k;
+}
+
+const char *num_error_text(Num_Error e){
+/* fits one 20 character LCD line */
+	switch (e){
+	case NUM_OK:		return "";
+	case NUM_EMPTY:		return "Short. Try Again";
+	case NUM_NODIGITS:	return "No Digits. Try Again";
+	case NUM_RANGE:		return "Long. Try Again";
+	default:			return "Bad Key. Try Again";
+	}
+}
+
+void num_in(char *prompt, Num_Value *v){
+/*
+ * Prompts on the first line and reads the keypad until ENT. Bad input
+ * shows why on the second line and the prompt is repeated.
+ */
+	char buffer[NUM_BUF];
+	Num_Error e;
+
+	putchar_lcd('\f');	// clear display
+	while (1){
+		putchar_lcd('\v');	// move to first line of display
+		printf_lcd(prompt);
+		buffer[0] = '\0';
+		fgets_keypad(buffer, NUM_BUF);
+		e = num_parse(buffer, v);
+		if (e == NUM_OK) return;
+		putchar_lcd('\f');
+		printf_lcd("\n%s", num_error_text(e));
+	}
+}
@@ -0,0 +1,45 @@
+/*
+ * numparse.h
+ * Author: Trenton
+ * Date: 05/09/25
+ * Description: Keypad number input.
+ * num_parse() checks and converts a keypad string in one pass: an optional
+ * '-' in the first position, digits, at most one '.', and at least one
+ * digit ("-." and "." are refused). The digits are kept as one integer
+ * and a count of digits after the radix, so callers that want an int or a
+ * fixed-point value get it exactly, without going through a double.
+ *
+ * num_in() is the prompt / re-prompt loop from double_in(), built on it.
+ */
+
+#ifndef NUMPARSE_H
+#define NUMPARSE_H
+
+#include <stdint.h>
+
+#define NUM_MAX_DIGITS 18	// most digits that fit in mant
+
+typedef enum {
+	NUM_OK = 0,
+	NUM_EMPTY,		// nothing entered
+	NUM_BADKEY,		// a key that isn't a digit, '-' or '.' (UP, DN)
+	NUM_SIGN,		// '-' after the first position
+	NUM_RADIX,		// more than one '.'
+	NUM_NODIGITS,	// sign and/or radix only, e.g. "-."
+	NUM_RANGE		// more than NUM_MAX_DIGITS digits
+} Num_Error;
+
+typedef struct {
+	int64_t mant;	// every digit as one integer, signed
+	int frac;		// digits after the radix: value = mant / 10^frac
+} Num_Value;
+
+Num_Error num_parse(const char *s, Num_Value *v);	// check and convert in one pass
+double num_double(const Num_Value *v);		// as a double, correctly rounded
+int64_t num_int(const Num_Value *v);		// truncated toward zero, like (int)
+int64_t num_fixed(const Num_Value *v, int places);	// value * 10^places, truncated
+const char *num_error_text(Num_Error e);	// LCD message for an error
+
+void num_in(char *prompt, Num_Value *v);	// prompt until a valid number is entered
+
+#endif
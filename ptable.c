@@ -0,0 +1,167 @@
+/*
+ * ptable.c
+ * Author: Trenton
+ * Date: 06/06/25
+ * Description: Parameter table editor with a version counter, see ptable.h.
+ * The table screen goes through the LCD screen model, so a repaint only
+ * sends the digits that changed. The edit prompt writes straight to the
+ * display (keypad_gets() echoes with putchar_lcd()), the model is marked
+ * out of date afterwards so the next repaint is a full one.
+ *
+ * Sequence counters: a write is counter + 1 (odd), copy, counter + 2, with
+ * a release fence before the copy and a release store after it. A read
+ * loads the counter with acquire, copies into a local, fences and loads
+ * the counter again; the local is only used if both loads are the same
+ * even number. The values are copied whole into a local first, so a torn
+ * read never reaches the caller's snapshot.
+ */
+
+/* includes */
+#include <string.h>
+#include "T1.h"
+#include "ptable.h"
+#include "keypad.h"
+#include "lcd.h"
+#include "fmt.h"
+#include "numparse.h"
+#include "timing.h"
+
+/* definitions */
+#define PTABLE_POLL_NS 10000000ULL	// keypad queue checked every 10 ms
+#define PTABLE_BUF 40				// keypad entry buffer
+
+// Functions ###################################################################
+
+static void seq_write(atomic_uint *seq, Ptable_Snap *dst, const Ptable_Snap *src){
+	unsigned s = atomic_load_explicit(seq, memory_order_relaxed);
+	atomic_store_explicit(seq, s + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+	memcpy(dst, src, sizeof(*dst));
+	atomic_store_explicit(seq, s + 2, memory_order_release);
+}
+
+static int seq_read(atomic_uint *seq, const Ptable_Snap *src, Ptable_Snap *dst){
+/* one try, returns 0 and leaves dst alone if a write was in progress */
+	Ptable_Snap copy;
+	unsigned s = atomic_load_explicit(seq, memory_order_acquire);
+	if (s & 1) return 0;
+	memcpy(&copy, src, sizeof(copy));
+	atomic_thread_fence(memory_order_acquire);
+	if (atomic_load_explicit(seq, memory_order_relaxed) != s) return 0;
+	*dst = copy;
+	return 1;
+}
+
+static void publish(Ptable *p){
+/* the entries and version into p->in, editor thread */
+	Ptable_Snap s;
+	int i;
+	s.version = p->version;
+	for (i = 0; i < p->nval; i++) s.value[i] = p->entries[i].value;
+	seq_write(&p->in_seq, &p->in, &s);
+}
+
+int ptable_init(Ptable *p, table *entries, int nval){
+/* call before the ISR thread starts */
+	if (nval < 0 || nval > PTABLE_MAX) return -1;
+	memset(p, 0, sizeof(*p));
+	p->entries = entries;
+	p->nval = nval;
+	atomic_init(&p->in_seq, 0);
+	atomic_init(&p->out_seq, 0);
+	publish(p);
+	p->out = p->in;
+	return 0;
+}
+
+int ptable_snapshot(Ptable *p, Ptable_Snap *s){
+	return seq_read(&p->in_seq, &p->in, s);
+}
+
+void ptable_report(Ptable *p, const Ptable_Snap *s){
+/* only this thread writes out, so this never waits */
+	seq_write(&p->out_seq, &p->out, s);
+}
+
+static void take_shown(Ptable *p){
+/* the ISR's show values into the entries, editor thread
+ * A report takes well under a microsecond, so the retry is short. */
+	Ptable_Snap s;
+	int i;
+	while (!seq_read(&p->out_seq, &p->out, &s)){}
+	for (i = 0; i < p->nval; i++){
+		if (p->entries[i].e_type == 0) p->entries[i].value = s.value[i];
+	}
+}
+
+static void screen_line(const char *s){
+/* one display line into the model, cut at LCD_COLS */
+	char line[LCD_COLS + 2];
+	int n = (int)strlen(s);
+	if (n > LCD_COLS) n = LCD_COLS;
+	memcpy(line, s, n);
+	if (n < LCD_COLS) line[n++] = '\n';	// a full line already wrapped
+	line[n] = '\0';
+	lcd_screen_puts(line);
+}
+
+static void show(char *title, Ptable *p, int sel, int top){
+	char line[LCD_COLS + 1];
+	int i;
+	take_shown(p);
+	lcd_screen_putc('\f');
+	screen_line(title);
+	for (i = top; i < top + PTABLE_LINES && i < p->nval; i++){
+		fmt_format(line, sizeof(line), "%c%s%g", i == sel ? '>' : ' ',
+				p->entries[i].e_label, p->entries[i].value);
+		screen_line(line);
+	}
+	lcd_flush();
+}
+
+static void edit(Ptable *p, int i){
+/* prompt until a valid number is entered, store it, bump the version */
+	char buffer[PTABLE_BUF];
+	Num_Value v;
+	Num_Error e = NUM_OK;
+	do {
+		lcd_puts("\f\n");
+		lcd_puts(num_error_text(e));	// empty the first time
+		lcd_puts("\v");
+		lcd_puts(p->entries[i].e_label);
+		buffer[0] = '\0';
+		keypad_gets(buffer, PTABLE_BUF);
+		e = num_parse(buffer, &v);
+	} while (e != NUM_OK);
+	p->entries[i].value = num_double(&v);
+	p->version++;
+	publish(p);
+	lcd_invalidate();	// the echo went around the screen model
+}
+
+int ptable_edit(char *title, Ptable *p){
+	Key_Event e;
+	uint64_t next = 0;	// next repaint
+	int sel = 0, top = 0;
+
+	while (1){
+		if (timing_now() >= next){
+			show(title, p, sel, top);
+			next = timing_now() + PTABLE_REFRESH_NS;
+		}
+		if (!keypad_poll(&e)){
+			timing_sleep(PTABLE_POLL_NS);
+			continue;
+		}
+		if (e.type != KEY_RELEASE) continue;	// act on release, like getkey()
+		if (e.key == DEL) return 0;
+		else if (e.key == UP && sel > 0) sel--;
+		else if (e.key == DN && sel < p->nval - 1) sel++;
+		else if (e.key == ENT && p->entries[sel].e_type == 1) edit(p, sel);
+		else continue;
+		// keep the selection on screen, repaint now
+		if (sel < top) top = sel;
+		if (sel >= top + PTABLE_LINES) top = sel - PTABLE_LINES + 1;
+		next = 0;
+	}
+}
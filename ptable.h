@@ -0,0 +1,67 @@
+/*
+ * ptable.h
+ * Author: Trenton
+ * Date: 06/06/25
+ * Description: Parameter table with a version counter.
+ * ctable2() edits the table in place and the ISR can't tell when that
+ * happened, so it has to recompute everything it derives from the table
+ * on every tick. A Ptable wraps the same table entries with a version
+ * that ptable_edit() bumps after every value it stores. A reader keeps
+ * the version its derived values were built from and only rebuilds when
+ * the table's version is different.
+ *
+ * The editor and the ISR never share the table entries directly. Each
+ * direction has its own copy of the values behind a sequence counter
+ * (seqlock): the writer makes the counter odd, copies the values and makes
+ * it even again, a reader copies and keeps the copy only if the counter
+ * was even and didn't move. The editor publishes the values and version
+ * after every edit, the ISR takes them with ptable_snapshot(), one try
+ * per tick, and keeps its last snapshot if the editor was in the middle of
+ * a write, so it never waits on the UI thread. The ISR publishes its show
+ * values with ptable_report(), which never waits either, and the editor
+ * reads them for the display, retrying if a report was in progress.
+ *
+ * ptable_edit() is used like ctable2(): UP/DN select an entry, ENT edits
+ * it (only e_type 1 entries), DEL returns. The title is on the first line
+ * and three entries below it, the selected one marked with '>'. The shown
+ * values are repainted every PTABLE_REFRESH_NS so values the ISR writes
+ * back stay current. Keys come from the keypad driver, which has to be
+ * started before ptable_edit() is called.
+ */
+
+#ifndef PTABLE_H
+#define PTABLE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "ctable2.h"
+
+#define PTABLE_REFRESH_NS 100000000ULL	// repaint shown values every 100 ms
+#define PTABLE_LINES 3					// entries on screen under the title
+#define PTABLE_MAX 8					// most entries in a Ptable
+
+/* one consistent set of values */
+typedef struct {
+	uint32_t version;			// edits these values include
+	double value[PTABLE_MAX];	// entries[i].value
+} Ptable_Snap;
+
+/* table entries and their version */
+typedef struct {
+	table *entries;				// same entries ctable2() takes, editor thread only
+	int nval;					// number of entries
+	uint32_t version;			// bumped after every edit, editor thread only
+	atomic_uint in_seq;			// odd while the editor writes in
+	Ptable_Snap in;				// editor -> ISR
+	atomic_uint out_seq;		// odd while the ISR writes out
+	Ptable_Snap out;			// ISR -> editor, show entries
+} Ptable;
+
+int ptable_init(Ptable *p, table *entries, int nval);	// -1 if nval > PTABLE_MAX
+int ptable_edit(char *title, Ptable *p);	// returns 0 when DEL is pressed
+
+/* ISR side, neither one waits */
+int ptable_snapshot(Ptable *p, Ptable_Snap *s);	// 1 if s was updated, 0 if kept
+void ptable_report(Ptable *p, const Ptable_Snap *s);	// publish the show values in s
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * pwm.c
+ * Author: Trenton
+ * Date: 08/01/25
+ * Description: Software PWM on a DIO pin, see pwm.h.
+ * Each wake-up of the ISR is one edge. At the start of a period it takes
+ * the settings, raises the pin (unless the pulse is 0) and arms the timer
+ * for the falling edge, or for the next period if there is no falling edge
+ * (0% or 100%). At the falling edge it lowers the pin and arms the timer
+ * for the next period. The pin is only written when its level changes.
+ *
+ * If a wake-up is so late that the following edge is already due, that
+ * edge is taken right away (the timer is armed for 1 us) and counted as
+ * late, and a period that started more than a period late starts over
+ * from now instead of catching up with short pulses.
+ *
+ * Dio_WriteBit() on the run pin and Dio_ReadBit() on the button pins from
+ * another thread both read, modify and write the bank's direction
+ * register. They agree on every bit once the pins are set up (run output,
+ * buttons inputs), so they don't undo each other.
+ */
+
+/* includes */
+#include <stdio.h>
+#include "pwm.h"
+#include "timing.h"
+
+// Functions ###################################################################
+
+static uint64_t pack(uint32_t period_us, uint32_t on_us){
+	if (on_us > period_us) on_us = period_us;
+	if (on_us < PWM_MIN_US) on_us = 0;
+	else if (period_us - on_us < PWM_MIN_US) on_us = period_us;
+	return (uint64_t)period_us << 32 | on_us;
+}
+
+void pwm_init(Pwm *p, MyRio_Dio *pin, uint32_t period_us, uint32_t on_us){
+	p->pin = pin;
+	atomic_init(&p->set, 0);
+	pwm_set(p, period_us, on_us);
+	p->period_us = 0;
+	p->on_us = 0;
+	p->off_next = 0;
+	p->level = 0;
+	p->periods = 0;
+	p->late = 0;
+	p->started = 0;
+	istat_init(&p->stat, "PWM IRQ");
+}
+
+void pwm_set(Pwm *p, uint32_t period_us, uint32_t on_us){
+	if (period_us < 2*PWM_MIN_US) period_us = 2*PWM_MIN_US;
+	atomic_store_explicit(&p->set, pack(period_us, on_us), memory_order_relaxed);
+}
+
+void pwm_duty(Pwm *p, double duty){
+/* keeps the period last set */
+	uint32_t period = atomic_load_explicit(&p->set, memory_order_relaxed) >> 32;
+	if (duty < 0) duty = 0;
+	if (duty > 1) duty = 1;
+	pwm_set(p, period, (uint32_t)(duty * period + 0.5));
+}
+
+static void pin(Pwm *p, int level){
+	if (level != p->level){
+		Dio_WriteBit(p->pin, level ? NiFpga_True : NiFpga_False);
+		p->level = level;
+	}
+}
+
+static void edge(Pwm *p, uint64_t now){
+/* the edge due at t_next, sets the one after it */
+	uint64_t set;
+	if (p->off_next){
+		pin(p, 0);
+		p->off_next = 0;
+		p->t_next = p->t_start + (uint64_t)p->period_us * TIMING_NS_PER_US;
+		return;
+	}
+	// a new period, with the settings as they are now
+	p->t_start = p->t_next;
+	if (now - p->t_start >= (uint64_t)p->period_us * TIMING_NS_PER_US) p->t_start = now;
+	set = atomic_load_explicit(&p->set, memory_order_relaxed);
+	p->period_us = (uint32_t)(set >> 32);
+	p->on_us = (uint32_t)set;
+	p->periods++;
+	pin(p, p->on_us > 0);
+	if (p->on_us > 0 && p->on_us < p->period_us){
+		p->off_next = 1;
+		p->t_next = p->t_start + (uint64_t)p->on_us * TIMING_NS_PER_US;
+	}
+	else p->t_next = p->t_start + (uint64_t)p->period_us * TIMING_NS_PER_US;
+}
+
+static void arm(Pwm *p){
+/* timer asserts at t_next, or in 1 us if that has passed */
+	uint64_t now = timing_now();
+	uint32_t us = 1;
+	if (p->t_next > now) us = (uint32_t)((p->t_next - now + TIMING_NS_PER_US/2) / TIMING_NS_PER_US);
+	else p->late++;
+	if (us == 0) us = 1;
+	istat_assert(&p->stat, p->t_next);
+	NiFpga_WriteU32(myrio_session, IRQTIMERWRITE, us);
+	NiFpga_WriteBool(myrio_session, IRQTIMERSETTIME, NiFpga_True);
+}
+
+static void* pwm_thread(void *resource){
+	Pwm *p = resource;
+	uint32_t irqAssert;
+
+	while (p->irqThreadRdy == NiFpga_True){
+		irqAssert = 0;
+		Irq_Wait(p->irqContext, TIMERIRQNO, &irqAssert, (NiFpga_Bool*)&p->irqThreadRdy);
+		if (!(irqAssert & (1<<TIMERIRQNO))) continue;
+		istat_wake(&p->stat);
+		edge(p, p->stat.t_wake);
+		arm(p);
+		istat_ack(&p->stat);
+		Irq_Acknowledge(irqAssert);
+	}
+	return NULL;
+}
+
+int pwm_start(Pwm *p, const Rt_Attr *a, Rt_Status *st){
+/* the first period starts PWM_MIN_US from now, pin low until then */
+	int32_t status;
+	Dio_WriteBit(p->pin, NiFpga_False);
+	p->level = 0;
+	p->timer.timerWrite = IRQTIMERWRITE;
+	p->timer.timerSet = IRQTIMERSETTIME;
+	status = Irq_RegisterTimerIrq(&p->timer, &p->irqContext, PWM_MIN_US);
+	if (status != 0) return status;
+	p->t_next = timing_now() + PWM_MIN_US * TIMING_NS_PER_US;
+	p->off_next = 0;
+	istat_assert(&p->stat, p->t_next);
+	p->irqThreadRdy = NiFpga_True;
+	status = rt_thread_create(&p->thread, a, pwm_thread, p, st);
+	if (status != 0){
+		p->irqThreadRdy = NiFpga_False;
+		Irq_UnregisterTimerIrq(&p->timer, p->irqContext);
+		return status;
+	}
+	p->started = 1;
+	return 0;
+}
+
+void pwm_stop(Pwm *p){
+/* if pwm_start() failed there is no thread or IRQ, only the pin to lower */
+	if (p->started){
+		p->started = 0;
+		p->irqThreadRdy = NiFpga_False;		// ends the loop at the next edge
+		pthread_join(p->thread, NULL);
+		Irq_UnregisterTimerIrq(&p->timer, p->irqContext);
+	}
+	Dio_WriteBit(p->pin, NiFpga_False);
+	p->level = 0;
+}
+
+void pwm_print(Pwm *p){
+	istat_print(&p->stat);
+	printf("PWM %u us, on %u us: %u periods, %u late edges\n", p->period_us, p->on_us,
+			p->periods, p->late);
+}
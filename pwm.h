@@ -0,0 +1,64 @@
+/*
+ * pwm.h
+ * Author: Trenton
+ * Date: 08/01/25
+ * Description: Software PWM on a DIO pin, timed by the timer IRQ.
+ * An ISR thread toggles the pin at the edge times of the wave: high at the
+ * start of each period, low on_us later. The timer is armed for each edge
+ * in microseconds, at its absolute time from the start of the period, so
+ * the wave doesn't depend on how often (or how late) the thread that sets
+ * the duty runs, and the period and pulse can be any number of us.
+ *
+ * pwm_set() and pwm_duty() can be called from any thread while the PWM
+ * runs. Period and on time are stored together in one atomic word, and the
+ * ISR takes them at the start of a period, so every period is either all
+ * old or all new settings.
+ *
+ * Pulses shorter than PWM_MIN_US are left out (0% for a short high, 100%
+ * for a short low), an edge that close to the one before can't be timed.
+ * The PWM uses the timer IRQ, so it can't run beside another timer ISR.
+ */
+
+#ifndef PWM_H
+#define PWM_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "MyRio.h"
+#include "DIO.h"
+#include "TimerIRQ.h"
+#include "istat.h"
+#include "rtthread.h"
+
+#define PWM_MIN_US 20		// shortest pulse, high or low
+
+typedef struct {
+	MyRio_Dio *pin;
+	_Atomic uint64_t set;	// period_us << 32 | on_us, from pwm_set()
+	uint32_t period_us;		// this period's
+	uint32_t on_us;
+	uint64_t t_start;		// this period's start
+	uint64_t t_next;		// next edge
+	int off_next;			// next edge is the falling one
+	int level;				// pin level written
+	uint32_t periods;		// periods started
+	uint32_t late;			// edges that came after the edge after them
+	Istat stat;				// edge latency, service time
+	MyRio_IrqTimer timer;
+	NiFpga_IrqContext irqContext;
+	NiFpga_Bool irqThreadRdy;
+	pthread_t thread;
+	int started;			// pwm_start() succeeded, pwm_stop() not yet run
+} Pwm;
+
+void pwm_init(Pwm *p, MyRio_Dio *pin, uint32_t period_us, uint32_t on_us);
+int pwm_start(Pwm *p, const Rt_Attr *a, Rt_Status *st);	// 0, or the failing status
+void pwm_stop(Pwm *p);			// ends the ISR thread if started, pin low
+
+/* any thread, from the next period on */
+void pwm_set(Pwm *p, uint32_t period_us, uint32_t on_us);
+void pwm_duty(Pwm *p, double duty);		// on time as a fraction of the period
+void pwm_print(Pwm *p);
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * qbiquad.c
+ * Author: Trenton
+ * Date: 05/30/25
+ * Description: Fixed-point biquad cascade, see qbiquad.h.
+ *
+ * Per section, with coefficients c in Q(qc) and signals in Q(qx):
+ * 	acc = c0*x + c1*x1 + c2*x2 - c3*y1 - c4*y2		(64 bit)
+ * 	y   = (acc + 2^(qc-1)) >> qc, saturated to +-lim
+ * A product of two int32 is at most 2^62, so it always fits; only the sum
+ * can overflow and each add saturates at the int64 limits instead.
+ */
+
+/* includes */
+#include <math.h>
+#include <complex.h>
+#include "qbiquad.h"
+
+/* definitions */
+#define NFREQ 64	// frequencies checked by qbq_quantize(), 0 to pi
+
+// Functions ###################################################################
+
+static inline int64_t sadd(int64_t a, int64_t b){
+/* a + b, saturated */
+	int64_t r;
+	if (__builtin_add_overflow(a, b, &r)) r = b < 0 ? INT64_MIN : INT64_MAX;
+	return r;
+}
+
+static inline int32_t sat(int64_t v, int32_t lim){
+	return v > lim ? lim : v < -lim ? -lim : (int32_t)v;
+}
+
+static int quantize(double v, int qc, int32_t *out){
+/* v in Q(qc), -1 if it doesn't fit in an int32 */
+	double s = nearbyint(ldexp(v, qc));
+	if (s > INT32_MAX || s < INT32_MIN) return -1;
+	*out = (int32_t)s;
+	return 0;
+}
+
+int32_t qbq_from_volts(const Qbq_Cascade *q, double v){
+	double s = v * q->to_q;
+	return s >= q->lim ? q->lim : s <= -q->lim ? -q->lim : (int32_t)lrint(s);
+}
+
+double qbq_to_volts(const Qbq_Cascade *q, int32_t x){
+	return x * q->to_v;
+}
+
+int qbq_init(Qbq_Cascade *q, const struct biquad *fa, int ns,
+		int qx, int qc, double fs, double ymin, double ymax){
+/* returns -1 if the format is out of range, an a0 is 0, or a coefficient
+ * doesn't fit in Q(qc) */
+	int i;
+	if (ns < 0 || ns > BQ_MAX_SECTIONS) return -1;
+	if (qx < 1 || qx > 31 || qc < 1 || qc > 30 || !(fs > 0)) return -1;
+	q->ns = ns;
+	q->qx = qx;
+	q->qc = qc;
+	q->fs = fs;
+	q->to_q = ldexp(1, qx) / fs;
+	q->to_v = fs / ldexp(1, qx);
+	q->lim = (int32_t)(((int64_t)1 << qx) - 1);
+	q->ymin = qbq_from_volts(q, ymin);
+	q->ymax = qbq_from_volts(q, ymax);
+	for (i = 0; i < ns; i++){
+		if (qbq_set(q, i, &fa[i]) < 0) return -1;
+		q->x[i][0] = qbq_from_volts(q, fa[i].x1);
+		q->x[i][1] = qbq_from_volts(q, fa[i].x2);
+		q->y[i][0] = qbq_from_volts(q, fa[i].y1);
+		q->y[i][1] = qbq_from_volts(q, fa[i].y2);
+	}
+	return 0;
+}
+
+int qbq_set(Qbq_Cascade *q, int i, const struct biquad *f){
+/* all five are checked before any is stored, so on -1 the section is unchanged */
+	int32_t c[5];
+	int k;
+	if (f->a0 == 0) return -1;
+	if (quantize(f->b0 / f->a0, q->qc, &c[0]) < 0 ||
+			quantize(f->b1 / f->a0, q->qc, &c[1]) < 0 ||
+			quantize(f->b2 / f->a0, q->qc, &c[2]) < 0 ||
+			quantize(f->a1 / f->a0, q->qc, &c[3]) < 0 ||
+			quantize(f->a2 / f->a0, q->qc, &c[4]) < 0) return -1;
+	for (k = 0; k < 5; k++) q->c[i][k] = c[k];
+	return 0;
+}
+
+void qbq_reset(Qbq_Cascade *q){
+	int i;
+	for (i = 0; i < q->ns; i++){
+		q->x[i][0] = q->x[i][1] = 0;
+		q->y[i][0] = q->y[i][1] = 0;
+	}
+}
+
+int32_t qbq_run(Qbq_Cascade *q, int32_t xin){
+	int32_t x = xin, y;
+	int32_t *c, *xs, *ys;
+	int64_t acc;
+	int i;
+	for (i = 0; i < q->ns; i++){
+		c = q->c[i];
+		xs = q->x[i];
+		ys = q->y[i];
+		acc = (int64_t)1 << (q->qc - 1);	// round to nearest
+		acc = sadd(acc, (int64_t)c[0] * x);
+		acc = sadd(acc, (int64_t)c[1] * xs[0]);
+		acc = sadd(acc, (int64_t)c[2] * xs[1]);
+		acc = sadd(acc, -(int64_t)c[3] * ys[0]);
+		acc = sadd(acc, -(int64_t)c[4] * ys[1]);
+		y = sat(acc >> q->qc, q->lim);
+		xs[1] = xs[0]; xs[0] = x;
+		ys[1] = ys[0]; ys[0] = y;
+		x = y;
+	}
+	return x < q->ymin ? q->ymin : x > q->ymax ? q->ymax : x;
+}
+
+double qbq_cascade(Qbq_Cascade *q, double xin){
+	return qbq_to_volts(q, qbq_run(q, qbq_from_volts(q, xin)));
+}
+
+static double complex response(const double c[5], double w){
+/* H(e^jw) of one section, c = b0 b1 b2 a1 a2 */
+	double complex z1 = cexp(-I*w), z2 = z1*z1;
+	double complex den = 1 + c[3]*z1 + c[4]*z2;
+	if (cabs(den) == 0) return INFINITY;
+	return (c[0] + c[1]*z1 + c[2]*z2) / den;
+}
+
+static double pole_shift(const double a[2], const double b[2]){
+/* how far the poles of 1 + a1/z + a2/z^2 move going to b, best pairing */
+	double complex ra = csqrt(a[0]*a[0] - 4*a[1]), rb = csqrt(b[0]*b[0] - 4*b[1]);
+	double complex pa0 = (-a[0] + ra)/2, pa1 = (-a[0] - ra)/2;
+	double complex pb0 = (-b[0] + rb)/2, pb1 = (-b[0] - rb)/2;
+	double straight = fmax(cabs(pa0 - pb0), cabs(pa1 - pb1));
+	double crossed = fmax(cabs(pa0 - pb1), cabs(pa1 - pb0));
+	return fmin(straight, crossed);
+}
+
+void qbq_quantize(const Qbq_Cascade *q, const struct biquad *fa, Qbq_Error *e){
+/* compares the quantized sections in q with the design in fa */
+	double cd[BQ_MAX_SECTIONS][5], cq[BQ_MAX_SECTIONS][5];
+	double complex hd, hq;
+	double w, d, err = 0, peak = 0;
+	int i, k;
+
+	e->coef = e->pole = e->resp = e->gain = 0;
+	for (i = 0; i < q->ns; i++){
+		cd[i][0] = fa[i].b0 / fa[i].a0;
+		cd[i][1] = fa[i].b1 / fa[i].a0;
+		cd[i][2] = fa[i].b2 / fa[i].a0;
+		cd[i][3] = fa[i].a1 / fa[i].a0;
+		cd[i][4] = fa[i].a2 / fa[i].a0;
+		for (k = 0; k < 5; k++){
+			cq[i][k] = ldexp((double)q->c[i][k], -q->qc);
+			e->coef = fmax(e->coef, fabs(cq[i][k] - cd[i][k]));
+		}
+		e->pole = fmax(e->pole, pole_shift(&cd[i][3], &cq[i][3]));
+	}
+	for (k = 0; k <= NFREQ; k++){
+		w = M_PI * k / NFREQ;
+		hd = hq = 1;
+		for (i = 0; i < q->ns; i++){
+			hd *= response(cd[i], w);
+			hq *= response(cq[i], w);
+			d = cabs(hd);
+			e->gain = isnan(d) ? INFINITY : fmax(e->gain, d);
+		}
+		if (k > 0){		// H of an integrator is infinite at w = 0
+			err = fmax(err, cabs(hq - hd));
+			peak = fmax(peak, cabs(hd));
+		}
+	}
+	e->resp = peak > 0 ? err / peak : 0;
+}
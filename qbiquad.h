@@ -0,0 +1,61 @@
+/*
+ * qbiquad.h
+ * Author: Trenton
+ * Date: 05/30/25
+ * Description: Fixed-point biquad cascade, the integer version of
+ * cascade() in biquad.c.
+ *
+ * Signals are signed integers with qx fraction bits, where 1.0 stands for
+ * fs volts: qx = 15 is Q15 (16 bit resolution, like the ADC), qx = 31 is
+ * Q31. Coefficients are int32 with qc fraction bits, divided by a0 when
+ * they are quantized, so qc = 29 holds anything in [-4, 4). Each section
+ * is direct form I: the five products go into one 64 bit accumulator,
+ * which is rounded back to qx bits once. The accumulator and every stored
+ * value saturate instead of wrapping.
+ *
+ * fs has to cover the largest signal anywhere in the cascade, not just the
+ * input and output. qbq_quantize() reports the gain to every section's
+ * output along with the error the quantized coefficients make.
+ */
+
+#ifndef QBIQUAD_H
+#define QBIQUAD_H
+
+#include <stdint.h>
+#include "biquad.h"
+
+/* fixed-point cascade */
+typedef struct {
+	int ns;							// sections in use
+	int qx;							// signal fraction bits, 1.0 = fs volts
+	int qc;							// coefficient fraction bits
+	double fs;						// volts at full scale
+	double to_q, to_v;				// 2^qx / fs and fs / 2^qx
+	int32_t lim;					// largest signal, 2^qx - 1
+	int32_t ymin, ymax;				// output saturation
+	int32_t c[BQ_MAX_SECTIONS][5];	// b0 b1 b2 a1 a2, divided by a0
+	int32_t x[BQ_MAX_SECTIONS][2];	// x1 x2 of each section
+	int32_t y[BQ_MAX_SECTIONS][2];	// y1 y2 of each section
+} Qbq_Cascade;
+
+/* what quantizing the coefficients did to the design */
+typedef struct {
+	double coef;	// largest coefficient error
+	double pole;	// largest distance a pole moved
+	double resp;	// largest relative error of H(e^jw), 0 < w <= pi
+	double gain;	// largest |H(e^jw)| up to any section's output, inf for an integrator
+} Qbq_Error;
+
+int qbq_init(Qbq_Cascade *q, const struct biquad *fa, int ns,
+		int qx, int qc, double fs, double ymin, double ymax);	// -1 on bad format or coefficient
+int qbq_set(Qbq_Cascade *q, int i, const struct biquad *f);	// new coefficients, state kept
+void qbq_reset(Qbq_Cascade *q);		// zero the state
+int32_t qbq_run(Qbq_Cascade *q, int32_t x);		// one sample in Q(qx)
+double qbq_cascade(Qbq_Cascade *q, double xin);	// one sample in volts
+
+int32_t qbq_from_volts(const Qbq_Cascade *q, double v);	// saturated
+double qbq_to_volts(const Qbq_Cascade *q, int32_t x);
+
+void qbq_quantize(const Qbq_Cascade *q, const struct biquad *fa, Qbq_Error *e);
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * rategrp.c
+ * Author: Trenton
+ * Date: 07/25/25
+ * Description: Rate group scheduler on one timer IRQ, see rategrp.h.
+ * Tick k is due at t0 + k*base. A wake-up runs the latest tick whose time
+ * has come (at least the one after the last), so after a long tick the
+ * ones in between are skipped instead of run late back to back. The
+ * releases a group lost that way are counted as its overruns.
+ *
+ * A release of a group is late when its last task finishes after
+ * t0 + (k + div)*base, the group's next release. The counters are plain
+ * words written by the ISR thread only, rg_print() reads them as they are.
+ */
+
+/* includes */
+#include <stdio.h>
+#include "rategrp.h"
+#include "timing.h"
+
+// Functions ###################################################################
+
+void rg_init(Rg_Sched *s, uint32_t base_us){
+	s->base_us = base_us;
+	s->ntask = 0;
+	s->ngroup = 0;
+	s->t0 = 0;
+	s->tick = 0;
+	s->skipped = 0;
+	s->started = 0;
+	istat_init(&s->stat, "Timer IRQ");
+}
+
+int rg_add(Rg_Sched *s, const char *name, uint32_t div, uint32_t phase, int prio,
+		void (*fn)(void*), void *arg){
+/* keeps task[] sorted by prio, tasks of the same prio in the order added */
+	int g, i;
+	if (s->ntask == RG_MAXTASK || div == 0) return -1;
+	phase %= div;
+	for (g = 0; g < s->ngroup; g++){
+		if (s->group[g].div == div && s->group[g].phase == phase) break;
+	}
+	if (g == s->ngroup){
+		if (g == RG_MAXGROUP) return -1;
+		s->group[g] = (Rg_Group){div, phase, 0, 0, 0, 0};
+		s->ngroup++;
+	}
+	for (i = s->ntask; i > 0 && s->task[i-1].prio > prio; i--) s->task[i] = s->task[i-1];
+	s->task[i] = (Rg_Task){name, fn, arg, prio, g, 0};
+	s->ntask++;
+	return 0;
+}
+
+static uint64_t releases(const Rg_Group *g, uint64_t k){
+/* releases of g on ticks 0 to k */
+	return k < g->phase ? 0 : (k - g->phase) / g->div + 1;
+}
+
+static void arm(Rg_Sched *s, uint64_t t){
+/* timer asserts at time t, at least 1 us from now */
+	uint64_t now = timing_now();
+	uint32_t us = t > now ? (uint32_t)((t - now + TIMING_NS_PER_US/2) / TIMING_NS_PER_US) : 1;
+	if (us == 0) us = 1;
+	istat_assert(&s->stat, t);
+	NiFpga_WriteU32(myrio_session, IRQTIMERWRITE, us);
+	NiFpga_WriteBool(myrio_session, IRQTIMERSETTIME, NiFpga_True);
+}
+
+static void tick(Rg_Sched *s, uint64_t k){
+/* the tasks due on tick k, in priority order */
+	uint64_t base = (uint64_t)s->base_us * TIMING_NS_PER_US;
+	uint64_t t_k = s->t0 + k*base, t;
+	Rg_Group *g;
+	Rg_Task *p;
+	int i;
+	for (i = 0; i < s->ntask; i++){
+		p = &s->task[i];
+		g = &s->group[p->group];
+		if (k % g->div != g->phase) continue;
+		t = timing_now();
+		p->fn(p->arg);
+		g->t_done = timing_now();
+		if (g->t_done - t > p->max_ns) p->max_ns = (uint32_t)(g->t_done - t);
+	}
+	for (i = 0; i < s->ngroup; i++){
+		g = &s->group[i];
+		if (k % g->div != g->phase) continue;
+		g->runs++;
+		t = g->t_done > t_k ? g->t_done - t_k : 0;
+		if (t > g->max_ns) g->max_ns = (uint32_t)t;
+		if (t > g->div * base) g->overruns++;
+	}
+}
+
+static void* rg_thread(void *resource){
+	Rg_Sched *s = resource;
+	uint64_t base = (uint64_t)s->base_us * TIMING_NS_PER_US, k, now;
+	uint32_t irqAssert;
+	int i;
+
+	while (s->irqThreadRdy == NiFpga_True){
+		irqAssert = 0;
+		Irq_Wait(s->irqContext, TIMERIRQNO, &irqAssert, (NiFpga_Bool*)&s->irqThreadRdy);
+		if (!(irqAssert & (1<<TIMERIRQNO))) continue;
+		istat_wake(&s->stat);
+		now = s->stat.t_wake;
+
+		// the latest tick that is due, not before the next one
+		k = now > s->t0 ? (now - s->t0) / base : 0;
+		if (k <= s->tick) k = s->tick + 1;
+		if (k > s->tick + 1){
+			s->skipped += (uint32_t)(k - s->tick - 1);
+			for (i = 0; i < s->ngroup; i++){
+				s->group[i].overruns += (uint32_t)(releases(&s->group[i], k - 1)
+						- releases(&s->group[i], s->tick));
+			}
+		}
+		s->tick = k;
+		arm(s, s->t0 + (k + 1)*base);
+
+		tick(s, k);
+		istat_ack(&s->stat);
+		Irq_Acknowledge(irqAssert);
+	}
+	return NULL;
+}
+
+int rg_start(Rg_Sched *s, const Rt_Attr *a, Rt_Status *st){
+/* tick 0 is now, tick 1 is the first one run */
+	int32_t status;
+	s->timer.timerWrite = IRQTIMERWRITE;
+	s->timer.timerSet = IRQTIMERSETTIME;
+	status = Irq_RegisterTimerIrq(&s->timer, &s->irqContext, s->base_us);
+	if (status != 0) return status;
+	s->t0 = timing_now();
+	s->tick = 0;
+	istat_assert(&s->stat, s->t0 + (uint64_t)s->base_us * TIMING_NS_PER_US);
+	s->irqThreadRdy = NiFpga_True;
+	status = rt_thread_create(&s->thread, a, rg_thread, s, st);
+	if (status != 0){
+		s->irqThreadRdy = NiFpga_False;
+		Irq_UnregisterTimerIrq(&s->timer, s->irqContext);
+		return status;
+	}
+	s->started = 1;
+	return 0;
+}
+
+void rg_stop(Rg_Sched *s){
+/* nothing to stop if rg_start() failed, it has released the IRQ */
+	if (!s->started) return;
+	s->started = 0;
+	s->irqThreadRdy = NiFpga_False;		// ends the loop at the next tick
+	pthread_join(s->thread, NULL);
+	Irq_UnregisterTimerIrq(&s->timer, s->irqContext);
+}
+
+void rg_print(Rg_Sched *s){
+	Rg_Group *g;
+	int i, j;
+	istat_print(&s->stat);
+	printf("%u us tick: %llu ticks, %u skipped\n", s->base_us, (unsigned long long)s->tick,
+			s->skipped);
+	for (i = 0; i < s->ngroup; i++){
+		g = &s->group[i];
+		printf("  %g Hz (div %u phase %u): runs %u  overruns %u  max %.1f us\n",
+				1e6 / ((double)s->base_us * g->div), g->div, g->phase, g->runs, g->overruns,
+				g->max_ns / 1e3);
+		for (j = 0; j < s->ntask; j++){
+			if (s->task[j].group != i) continue;
+			printf("    %s (prio %d): max %.1f us\n", s->task[j].name, s->task[j].prio,
+					s->task[j].max_ns / 1e3);
+		}
+	}
+}
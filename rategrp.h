@@ -0,0 +1,84 @@
+/*
+ * rategrp.h
+ * Author: Trenton
+ * Date: 07/25/25
+ * Description: Rate group scheduler on one timer IRQ.
+ * Tasks are registered at a whole multiple (div) of the base tick, e.g.
+ * with a 500 us tick:
+ * 	div 1		2 kHz filter
+ * 	div 10		200 Hz velocity loop
+ * 	div 200		10 Hz display and telemetry
+ * The tasks with the same div and phase make up a rate group, released on
+ * the ticks k where k % div == phase. A phase keeps a slow group off the
+ * ticks a faster one runs on.
+ *
+ * The scheduler owns what each lab wrote around its ISR: the timer IRQ,
+ * the ISR thread (rtthread.c) and the Irq_Wait() loop. On each tick it
+ * runs the tasks that are due one after another on that thread, in
+ * priority order (lowest number first), so tasks never preempt each other
+ * and don't need locks between them.
+ *
+ * The timer is armed for the absolute time of the next tick, t0 + k*base,
+ * rather than base after the wake-up, so the rates don't drift with the
+ * wake-up latency. A tick whose time has passed by the time the ISR gets
+ * to it is skipped and counted.
+ *
+ * Each group counts its overruns: releases whose tasks were still running
+ * at the group's next release, plus releases lost to skipped ticks. The
+ * base tick's wake-up latency and service time go into an Istat.
+ */
+
+#ifndef RATEGRP_H
+#define RATEGRP_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "MyRio.h"
+#include "TimerIRQ.h"
+#include "istat.h"
+#include "rtthread.h"
+
+#define RG_MAXTASK 16
+#define RG_MAXGROUP 8
+
+typedef struct {
+	const char *name;
+	void (*fn)(void *arg);
+	void *arg;
+	int prio;				// lower runs first
+	int group;				// index in group[]
+	uint32_t max_ns;		// longest run
+} Rg_Task;
+
+typedef struct {
+	uint32_t div, phase;
+	uint32_t runs;			// releases run
+	uint32_t overruns;		// late or skipped releases
+	uint32_t max_ns;		// longest release to last task done
+	uint64_t t_done;		// last task of this release done
+} Rg_Group;
+
+typedef struct {
+	uint32_t base_us;		// base tick
+	int ntask, ngroup;
+	Rg_Task task[RG_MAXTASK];		// in priority order
+	Rg_Group group[RG_MAXGROUP];
+	uint64_t t0;			// time of tick 0
+	uint64_t tick;			// last tick run
+	uint32_t skipped;		// ticks skipped
+	Istat stat;				// base tick latency, service time
+	MyRio_IrqTimer timer;
+	NiFpga_IrqContext irqContext;
+	NiFpga_Bool irqThreadRdy;
+	pthread_t thread;
+	int started;			// rg_start() succeeded, rg_stop() not yet run
+} Rg_Sched;
+
+void rg_init(Rg_Sched *s, uint32_t base_us);
+int rg_add(Rg_Sched *s, const char *name, uint32_t div, uint32_t phase, int prio,
+		void (*fn)(void*), void *arg);		// 0, or -1 if full
+int rg_start(Rg_Sched *s, const Rt_Attr *a, Rt_Status *st);	// 0, or the failing status
+void rg_stop(Rg_Sched *s);		// end the ISR thread and unregister the IRQ, if started
+void rg_print(Rg_Sched *s);		// any thread
+
+#endif
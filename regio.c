@@ -0,0 +1,100 @@
+/*
+ * regio.c
+ * Author: Trenton
+ * Date: 04/25/25
+ * Description: Grouped register I/O, see regio.h.
+ *
+ * dio_bank_write() writes the output register before the direction
+ * register, so a pin that turns into an output starts at its new level
+ * instead of briefly driving the old one.
+ */
+
+/* includes */
+#include "MyRio.h"
+#include "regio.h"
+
+// Functions ###################################################################
+
+void dio_bank_init(Dio_Bank *b, uint32_t dir, uint32_t out, uint32_t in){
+/* takes the current dir and out values from the FPGA */
+	b->dir = dir;
+	b->out = out;
+	b->in = in;
+	NiFpga_ReadU8(myrio_session, dir, &b->dir_v);
+	NiFpga_ReadU8(myrio_session, out, &b->out_v);
+}
+
+void dio_bank_write(Dio_Bank *b, uint8_t mask, uint8_t dir, uint8_t out){
+/* pins in mask take their bits of dir (1 = output) and out, others keep theirs */
+	uint8_t d = (b->dir_v & ~mask) | (dir & mask);
+	uint8_t o = (b->out_v & ~mask) | (out & mask);
+	if (o != b->out_v){
+		NiFpga_WriteU8(myrio_session, b->out, o);
+		b->out_v = o;
+	}
+	if (d != b->dir_v){
+		NiFpga_WriteU8(myrio_session, b->dir, d);
+		b->dir_v = d;
+	}
+}
+
+uint8_t dio_bank_read(Dio_Bank *b){
+	uint8_t v = 0;
+	NiFpga_ReadU8(myrio_session, b->in, &v);
+	return v;
+}
+
+void io_tx_init(Io_Tx *t){
+	t->nenc = t->nai = t->nao = 0;
+	t->timer_us = 0;
+}
+
+int io_tx_encoder(Io_Tx *t, MyRio_Encoder *enc){
+	if (t->nenc >= IO_TX_MAX) return -1;
+	t->enc[t->nenc] = enc;
+	t->count[t->nenc] = Encoder_Counter(enc);
+	return t->nenc++;
+}
+
+int io_tx_ai(Io_Tx *t, MyRio_Aio *ai){
+	if (t->nai >= IO_TX_MAX) return -1;
+	t->ai[t->nai] = ai;
+	t->vin[t->nai] = 0;
+	return t->nai++;
+}
+
+int io_tx_ao(Io_Tx *t, MyRio_Aio *ao, double v){
+/* the output is written once here so vsent matches the DAC */
+	if (t->nao >= IO_TX_MAX) return -1;
+	t->ao[t->nao] = ao;
+	t->vout[t->nao] = v;
+	t->vsent[t->nao] = v;
+	Aio_Write(ao, v);
+	return t->nao++;
+}
+
+void io_tx_read(Io_Tx *t){
+/* encoders first, they are the time critical samples */
+	int i;
+	for (i = 0; i < t->nenc; i++) t->count[i] = Encoder_Counter(t->enc[i]);
+	for (i = 0; i < t->nai; i++) t->vin[i] = Aio_Read(t->ai[i]);
+}
+
+void io_tx_write(Io_Tx *t){
+	int i;
+	for (i = 0; i < t->nao; i++){
+		if (t->vout[i] != t->vsent[i]){
+			Aio_Write(t->ao[i], t->vout[i]);
+			t->vsent[i] = t->vout[i];
+		}
+	}
+}
+
+void io_tx_timer(Io_Tx *t, uint32_t us){
+/* IRQTIMERWRITE holds its value, it only needs writing when the period changes */
+	if (us != t->timer_us){
+		NiFpga_WriteU32(myrio_session, IRQTIMERWRITE, us);
+		t->timer_us = us;
+	}
+	NiFpga_WriteBool(myrio_session, IRQTIMERSETTIME, NiFpga_True);
+}
@@ -0,0 +1,65 @@
+/*
+ * regio.h
+ * Author: Trenton
+ * Date: 04/25/25
+ * Description: Grouped register I/O for the ISRs and the keypad scan.
+ * Dio_ReadBit/Dio_WriteBit touch the direction, output and input registers
+ * for every single pin. A Dio_Bank works on a whole DIOx_70 bank at once
+ * and keeps copies of its direction and output registers, so a register
+ * is only written when its value actually changes and all 8 pins are read
+ * with one access.
+ *
+ * Io_Tx groups the encoder, analog input and analog output channels an ISR
+ * uses. Their descriptors are set up once, io_tx_read() samples every input
+ * together at the start of the tick and io_tx_write() sends every output
+ * together at the end, skipping outputs that haven't changed.
+ *
+ * A Dio_Bank assumes it is the only writer of its bank's direction and
+ * output registers. Don't mix it with Dio_WriteBit on the same bank.
+ */
+
+#ifndef REGIO_H
+#define REGIO_H
+
+#include <stdint.h>
+#include "MyRio.h"
+#include "AIO.h"
+#include "Encoder.h"
+
+#define IO_TX_MAX 4		// channels of each kind in one transaction
+
+/* one 8 pin DIO bank */
+typedef struct {
+	uint32_t dir;		// direction register, 1 = output
+	uint32_t out;		// output register
+	uint32_t in;		// input register
+	uint8_t dir_v;		// last value written to dir
+	uint8_t out_v;		// last value written to out
+} Dio_Bank;
+
+void dio_bank_init(Dio_Bank *b, uint32_t dir, uint32_t out, uint32_t in);
+void dio_bank_write(Dio_Bank *b, uint8_t mask, uint8_t dir, uint8_t out);	// pins in mask
+uint8_t dio_bank_read(Dio_Bank *b);		// all 8 pin levels, one access
+
+/* the channels an ISR reads and writes every tick */
+typedef struct {
+	int nenc, nai, nao;
+	MyRio_Encoder *enc[IO_TX_MAX];
+	MyRio_Aio *ai[IO_TX_MAX];
+	MyRio_Aio *ao[IO_TX_MAX];
+	uint32_t count[IO_TX_MAX];	// encoder counts, set by io_tx_read()
+	double vin[IO_TX_MAX];		// input volts, set by io_tx_read()
+	double vout[IO_TX_MAX];		// output volts, sent by io_tx_write()
+	double vsent[IO_TX_MAX];	// last volts sent
+	uint32_t timer_us;			// last value written to IRQTIMERWRITE
+} Io_Tx;
+
+void io_tx_init(Io_Tx *t);
+int io_tx_encoder(Io_Tx *t, MyRio_Encoder *enc);	// slot in count[], or -1
+int io_tx_ai(Io_Tx *t, MyRio_Aio *ai);				// slot in vin[], or -1
+int io_tx_ao(Io_Tx *t, MyRio_Aio *ao, double v);	// slot in vout[], writes v now
+void io_tx_read(Io_Tx *t);		// sample every encoder and input
+void io_tx_write(Io_Tx *t);		// send the outputs that changed
+void io_tx_timer(Io_Tx *t, uint32_t us);	// re-arm the timer IRQ in us
+
+#endif
@@ -0,0 +1,173 @@
+/*
+ * rtthread.c
+ * Author: Trenton
+ * Date: 07/18/25
+ * Description: Real time thread launcher, see rtthread.h.
+ * The thread is first created with everything in its attributes. If that
+ * is refused (EPERM without the privilege for the policy, EINVAL for a
+ * core that isn't there) it is created with only the stack size, and the
+ * policy and the core are tried one at a time on the running thread, so
+ * one refusal doesn't cost the other. The new thread waits on a semaphore
+ * until that is done, then touches its stack and lets the launcher go
+ * before it calls fn().
+ *
+ * mlockall() is MCL_CURRENT and comes after the thread is created, so the
+ * new stack is one of the mappings it locks. MCL_FUTURE would also lock
+ * (and fill in) the whole default 8 MB stack of every thread started
+ * later, the keypad scan and telemetry writer included.
+ *
+ * The host simulation keeps the ISR thread at SCHED_OTHER (reported as
+ * not supported): its virtual clock only moves when every thread has
+ * waited, and a SCHED_FIFO thread waiting on it in a loop keeps the UI
+ * thread off a single core for good.
+ */
+
+#define _GNU_SOURCE
+/* includes */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include "MyRio.h"
+#include "rtthread.h"
+
+/* start-up handshake, on the launcher's stack */
+typedef struct {
+	void *(*fn)(void*);
+	void *arg;
+	size_t prefault;
+	sem_t go;				// settings done
+	sem_t ready;			// stack touched, fn and arg copied
+} Start;
+
+// Functions ###################################################################
+
+static __attribute__((noinline)) void prefault(size_t n){
+/* n bytes of stack below this frame, one write per page
+ * The writes go through a volatile pointer so they aren't optimized out. */
+	char buf[n];
+	volatile char *p = buf;
+	size_t i;
+	for (i = 0; i < n; i += 4096) p[i] = 0;
+	p[n-1] = 0;
+}
+
+static void* start(void *p){
+	Start *s = p;
+	void *(*fn)(void*) = s->fn;
+	void *arg = s->arg;
+	sem_wait(&s->go);
+	if (s->prefault) prefault(s->prefault);
+#ifdef MYRIO_SIM
+	void *r;
+	// known before the launcher goes on, posts ready: s is gone after this
+	sim_thread_register(1, &s->ready);
+	r = fn(arg);
+	sim_thread_unregister();
+	return r;
+#else
+	sem_post(&s->ready);	// s is gone after this
+	return fn(arg);
+#endif
+}
+
+static void read_back(pthread_t t, Rt_Status *st){
+	struct sched_param sp;
+	cpu_set_t set;
+	int i;
+	if (pthread_getschedparam(t, &st->policy, &sp) == 0) st->priority = sp.sched_priority;
+	st->cpu = -1;
+	if (pthread_getaffinity_np(t, sizeof(set), &set) == 0 && CPU_COUNT(&set) == 1){
+		for (i = 0; i < CPU_SETSIZE && !CPU_ISSET(i, &set); i++){}
+		st->cpu = i;
+	}
+}
+
+int rt_thread_create(pthread_t *t, const Rt_Attr *a, void *(*fn)(void*), void *arg,
+		Rt_Status *st){
+	pthread_attr_t at;
+	struct sched_param sp;
+	cpu_set_t set;
+	Start s;
+	int r;
+
+	memset(st, 0, sizeof(*st));
+#ifdef MYRIO_SIM
+	Rt_Attr b = *a;
+	if (b.policy != SCHED_OTHER){
+		b.policy = SCHED_OTHER;
+		st->sched_err = ENOTSUP;
+	}
+	a = &b;
+#endif
+	s.fn = fn;
+	s.arg = arg;
+	s.prefault = a->prefault;
+	sem_init(&s.go, 0, 0);
+	sem_init(&s.ready, 0, 0);
+	memset(&sp, 0, sizeof(sp));
+	sp.sched_priority = a->priority;
+	CPU_ZERO(&set);
+	if (a->cpu >= 0) CPU_SET(a->cpu, &set);
+
+	// everything at once
+	pthread_attr_init(&at);
+	if (a->stack) pthread_attr_setstacksize(&at, a->stack);
+	if (a->policy != SCHED_OTHER){
+		pthread_attr_setinheritsched(&at, PTHREAD_EXPLICIT_SCHED);
+		pthread_attr_setschedpolicy(&at, a->policy);
+		pthread_attr_setschedparam(&at, &sp);
+	}
+	if (a->cpu >= 0) pthread_attr_setaffinity_np(&at, sizeof(set), &set);
+	r = pthread_create(t, &at, start, &s);
+	pthread_attr_destroy(&at);
+
+	// refused: a plain thread, then one setting at a time
+	if (r == EPERM || r == EINVAL){
+		pthread_attr_init(&at);
+		if (a->stack) pthread_attr_setstacksize(&at, a->stack);
+		r = pthread_create(t, &at, start, &s);
+		pthread_attr_destroy(&at);
+		if (r == 0 && a->policy != SCHED_OTHER) st->sched_err = pthread_setschedparam(*t, a->policy, &sp);
+		if (r == 0 && a->cpu >= 0) st->pin_err = pthread_setaffinity_np(*t, sizeof(set), &set);
+	}
+	if (r == 0){
+		if (a->lock){
+			st->locked = mlockall(MCL_CURRENT) == 0;
+			st->lock_err = st->locked ? 0 : errno;
+		}
+		read_back(*t, st);
+		sem_post(&s.go);
+		sem_wait(&s.ready);
+		st->prefault = a->prefault;
+	}
+	sem_destroy(&s.go);
+	sem_destroy(&s.ready);
+	return r;
+}
+
+static const char* policy_name(int p){
+	return p == SCHED_FIFO ? "SCHED_FIFO" : p == SCHED_RR ? "SCHED_RR" : "SCHED_OTHER";
+}
+
+void rt_report(const char *name, const Rt_Attr *a, const Rt_Status *st){
+/* one line per setting asked for */
+	printf("%s:\n", name);
+	if (a->policy != SCHED_OTHER){
+		printf("  %s %d: ", policy_name(a->policy), a->priority);
+		if (st->policy == a->policy && st->priority == a->priority) printf("yes\n");
+		else printf("no (%s), running %s %d\n", strerror(st->sched_err ? st->sched_err : EPERM),
+				policy_name(st->policy), st->priority);
+	}
+	if (a->cpu >= 0){
+		printf("  cpu %d: ", a->cpu);
+		if (st->cpu == a->cpu) printf("yes\n");
+		else printf("no (%s), any cpu\n", strerror(st->pin_err ? st->pin_err : EINVAL));
+	}
+	if (a->lock){
+		if (st->locked) printf("  mlockall: yes\n");
+		else printf("  mlockall: no (%s)\n", strerror(st->lock_err));
+	}
+	if (a->prefault) printf("  stack: %zu KB touched\n", st->prefault / 1024);
+}
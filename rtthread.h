@@ -0,0 +1,60 @@
+/*
+ * rtthread.h
+ * Author: Trenton
+ * Date: 07/18/25
+ * Description: Real time thread launcher.
+ * pthread_create() with default attributes starts an ISR thread at the
+ * same priority as the UI thread, the keypad scan and the LCD writes, on
+ * whatever core is free, and its stack and data can still page fault.
+ * rt_thread_create() starts it with:
+ * 	a scheduling policy and priority (SCHED_FIFO above everything else)
+ * 	a core it stays on
+ * 	mlockall(), so no page mapped so far (code, static data, heap, the
+ * 	new stack) is paged out or faulted in late
+ * 	a smaller stack, the first part of it touched before fn() runs
+ * Each setting that is refused (no privileges, no such core) is left out
+ * and the thread runs anyway, with the others. What took effect is read
+ * back from the running thread into an Rt_Status, and rt_report() prints
+ * it, so a run without root says so instead of quietly running at normal
+ * priority.
+ */
+
+#ifndef RTTHREAD_H
+#define RTTHREAD_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define RT_PRIO_ISR 80				// above the kernel's default 50 for IRQ threads
+#define RT_CPU_ISR 1				// the myRIO's second core
+#define RT_STACK (256*1024)			// ISR thread stack
+#define RT_PREFAULT (64*1024)		// stack touched before the ISR starts
+
+typedef struct {
+	int policy;				// SCHED_FIFO, SCHED_RR, or SCHED_OTHER to leave it
+	int priority;			// 1 to 99 for FIFO/RR
+	int cpu;				// core, -1 for any
+	int lock;				// 1: mlockall(MCL_CURRENT) with the stack mapped
+	size_t stack;			// stack size, 0 for the default
+	size_t prefault;		// stack bytes to touch, 0 for none
+} Rt_Attr;
+
+/* settings for the labs' ISR threads */
+#define RT_ATTR_ISR {SCHED_FIFO, RT_PRIO_ISR, RT_CPU_ISR, 1, RT_STACK, RT_PREFAULT}
+
+/* what took effect, read back from the thread; err = errno, 0 if it took */
+typedef struct {
+	int policy, priority;	// as the thread runs
+	int cpu;				// the one core it runs on, or -1
+	int sched_err;
+	int pin_err;
+	int locked, lock_err;
+	size_t prefault;		// bytes touched
+} Rt_Status;
+
+int rt_thread_create(pthread_t *t, const Rt_Attr *a, void *(*fn)(void*), void *arg,
+		Rt_Status *st);		// pthread_create() result, only fails if a plain thread does
+void rt_report(const char *name, const Rt_Attr *a, const Rt_Status *st);
+
+#endif
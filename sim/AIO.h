@@ -0,0 +1,40 @@
+/*
+ * AIO.h (host simulation)
+ * Analog input/output channels. Inputs come from the signal sources set
+ * with sim_aio_source(), outputs are latched and can be read back with
+ * sim_aio_output().
+ */
+
+#ifndef MYRIO_SIM_AIO_H
+#define MYRIO_SIM_AIO_H
+
+#include "MyRio.h"
+
+/* simulated analog channels */
+typedef enum {
+	SIM_AI_A0 = 0, SIM_AI_A1, SIM_AI_A2, SIM_AI_A3,
+	SIM_AI_B0, SIM_AI_B1, SIM_AI_B2, SIM_AI_B3,
+	SIM_AI_C0, SIM_AI_C1,
+	SIM_AO_A0, SIM_AO_A1,
+	SIM_AO_B0, SIM_AO_B1,
+	SIM_AO_C0, SIM_AO_C1,
+	SIM_AIO_COUNT
+} Sim_AioChannel;
+
+typedef struct {
+	int chan;	// Sim_AioChannel
+} MyRio_Aio;
+
+double Aio_Read(MyRio_Aio *channel);			// read input voltage (volts)
+void Aio_Write(MyRio_Aio *channel, double value);	// write output voltage (volts)
+
+// connector C helpers, as in the T1 library
+void Aio_InitCI0(MyRio_Aio *AIC0);	// Input 0
+void Aio_InitCI1(MyRio_Aio *AIC1);	// Input 1
+void Aio_InitCO0(MyRio_Aio *AOC0);	// Output 0
+void Aio_InitCO1(MyRio_Aio *AOC1);	// Output 1
+
+// any channel, for connectors A and B
+void Sim_AioInit(MyRio_Aio *channel, Sim_AioChannel chan);
+
+#endif
@@ -0,0 +1,35 @@
+/*
+ * DIIRQ.h (host simulation)
+ * Digital input interrupt. Edges are scripted with sim_di_edge().
+ */
+
+#ifndef MYRIO_SIM_DIIRQ_H
+#define MYRIO_SIM_DIIRQ_H
+
+#include "IRQConfigure.h"
+
+typedef enum {
+	Irq_Dio_A0 = 0, Irq_Dio_A1, Irq_Dio_A2, Irq_Dio_A3
+} Irq_Dio_Channel;
+
+typedef enum {
+	Irq_Dio_RisingEdge = 0,
+	Irq_Dio_FallingEdge,
+	Irq_Dio_Edge
+} Irq_Dio_Type;
+
+typedef struct {
+	uint32_t dioCount;
+	uint32_t dioIrqNumber;
+	uint32_t dioIrqEnable;
+	uint32_t dioIrqRisingEdge;
+	uint32_t dioIrqFallingEdge;
+	Irq_Dio_Channel dioChannel;
+} MyRio_IrqDi;
+
+int32_t Irq_RegisterDiIrq(MyRio_IrqDi *irqChannel, NiFpga_IrqContext *irqContext,
+		uint8_t irqNumber, uint32_t count, Irq_Dio_Type type);
+int32_t Irq_UnregisterDiIrq(MyRio_IrqDi *irqChannel, NiFpga_IrqContext irqContext,
+		uint8_t irqNumber);
+
+#endif
@@ -0,0 +1,22 @@
+/*
+ * DIO.h (host simulation)
+ * Digital input/output channels on the simulated register file.
+ */
+
+#ifndef MYRIO_SIM_DIO_H
+#define MYRIO_SIM_DIO_H
+
+#include "MyRio.h"
+
+/* channel description, same fields as the target header */
+typedef struct {
+	uint32_t dir;	// direction register
+	uint32_t out;	// output register
+	uint32_t in;	// input register
+	uint8_t bit;	// bit index in the bank
+} MyRio_Dio;
+
+NiFpga_Bool Dio_ReadBit(MyRio_Dio *channel);	// reads dio bit, sets channel to high-z
+void Dio_WriteBit(MyRio_Dio *channel, NiFpga_Bool value);	// digital output write
+
+#endif
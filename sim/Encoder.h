@@ -0,0 +1,22 @@
+/*
+ * Encoder.h (host simulation)
+ * Quadrature encoder counters. Counts come from sim_encoder_source() or
+ * from the motor model set up with sim_motor().
+ */
+
+#ifndef MYRIO_SIM_ENCODER_H
+#define MYRIO_SIM_ENCODER_H
+
+#include "MyRio.h"
+
+#define SIM_NUM_ENCODERS 2
+
+typedef struct {
+	int index;	// simulated counter index, 0 is connector C encoder 0
+} MyRio_Encoder;
+
+NiFpga_Status EncoderC_initialize(NiFpga_Session myrio_session,
+		MyRio_Encoder *channel);	// Encoder initialize
+uint32_t Encoder_Counter(MyRio_Encoder *channel); // Encoder count retrieval
+
+#endif
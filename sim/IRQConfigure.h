@@ -0,0 +1,22 @@
+/*
+ * IRQConfigure.h (host simulation)
+ * Interrupt wait/acknowledge shared by the timer and DI interrupts.
+ *
+ * Irq_Wait() advances the virtual clock to the next pending event for its
+ * IRQ number (timer deadline or scripted DI edge), so an ISR thread runs as
+ * fast as the host allows. With nothing pending it sleeps briefly in real
+ * time and returns with no IRQ asserted, like a timeout on the target.
+ */
+
+#ifndef MYRIO_SIM_IRQCONFIGURE_H
+#define MYRIO_SIM_IRQCONFIGURE_H
+
+#include "MyRio.h"
+
+#define SIM_NUM_IRQS 8
+
+void Irq_Wait(NiFpga_IrqContext irqContext, uint8_t irqNumber,
+		uint32_t *irqAssert, NiFpga_Bool *continueWaiting);
+void Irq_Acknowledge(uint32_t irqAssert);
+
+#endif
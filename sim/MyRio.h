@@ -0,0 +1,77 @@
+/*
+ * MyRio.h (host simulation)
+ * Author: Trenton
+ * Date: 03/21/25
+ * Description: Stand-in for the NI MyRio.h header when building the labs
+ * on a plain Linux box. Only the types, registers and calls used by the
+ * labs are provided. The registers are fake addresses into the simulated
+ * register file in myrio_sim.c, they are NOT the real FPGA addresses.
+ *
+ * Build a lab on the host with the sim directory first on the include path:
+ *   gcc -Isim main-6.c sim/myrio_sim.c sim/T1_sim.c sim/matlabfiles.c -lpthread -lm
+ */
+
+#ifndef MYRIO_SIM_MYRIO_H
+#define MYRIO_SIM_MYRIO_H
+
+/* includes */
+#include <stdint.h>
+#include <stddef.h>
+
+// set when the simulated backend is in use, modules check this to pick
+// the virtual clock instead of the hardware one
+#define MYRIO_SIM 1
+
+/* NiFpga basic types */
+typedef int32_t  NiFpga_Status;
+typedef uint8_t  NiFpga_Bool;
+typedef uint32_t NiFpga_Session;
+typedef void*    NiFpga_IrqContext;
+
+#define NiFpga_True  ((NiFpga_Bool)1)
+#define NiFpga_False ((NiFpga_Bool)0)
+#define NiFpga_Status_Success 0
+
+#define MyRio_IsNotSuccess(status) ((status) < NiFpga_Status_Success)
+#define MyRio_IsSuccess(status)    ((status) >= NiFpga_Status_Success)
+
+/* register file (simulated addresses) */
+// DIO banks, 8 bits each: dir, out, in
+#define DIOA_70DIR 0x00
+#define DIOA_70OUT 0x01
+#define DIOA_70IN  0x02
+#define DIOB_70DIR 0x03
+#define DIOB_70OUT 0x04
+#define DIOB_70IN  0x05
+#define DIOC_70DIR 0x06
+#define DIOC_70OUT 0x07
+#define DIOC_70IN  0x08
+// timer IRQ
+#define IRQTIMERWRITE   0x10
+#define IRQTIMERSETTIME 0x11
+// DI IRQ configuration on connector A
+#define IRQDIO_A_0CNT   0x20
+#define IRQDIO_A_0NO    0x21
+#define IRQDIO_A_70ENA  0x22
+#define IRQDIO_A_70RISE 0x23
+#define IRQDIO_A_70FALL 0x24
+
+#define SIM_NUM_REGS 0x30
+
+/* prototypes */
+NiFpga_Status MyRio_Open(void);		// open FPGA session (keeps the simulation as set up)
+NiFpga_Status MyRio_Close(void);	// close FPGA session
+
+NiFpga_Status NiFpga_WriteU32(NiFpga_Session session, uint32_t reg, uint32_t value);
+NiFpga_Status NiFpga_WriteBool(NiFpga_Session session, uint32_t reg, NiFpga_Bool value);
+NiFpga_Status NiFpga_ReadU32(NiFpga_Session session, uint32_t reg, uint32_t *value);
+NiFpga_Status NiFpga_ReadBool(NiFpga_Session session, uint32_t reg, NiFpga_Bool *value);
+// 8 bit access, a read of a DIO input register returns all 8 pin levels
+NiFpga_Status NiFpga_WriteU8(NiFpga_Session session, uint32_t reg, uint8_t value);
+NiFpga_Status NiFpga_ReadU8(NiFpga_Session session, uint32_t reg, uint8_t *value);
+
+extern NiFpga_Session myrio_session;	// as on the target, labs may define their own
+
+#include "myrio_sim.h"	// virtual clock and signal script controls
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * T1.h (host simulation)
+ * Keypad codes and the T1 library routines. The simulated versions in
+ * T1_sim.c are weak, so a lab that defines its own putchar_lcd(), getkey()
+ * etc. links against its own.
+ */
+
+#ifndef MYRIO_SIM_T1_H
+#define MYRIO_SIM_T1_H
+
+#include <stdio.h>
+#include "MyRio.h"
+#include "DIO.h"
+#include "AIO.h"
+#include "UART.h"
+
+/* keypad codes */
+#define UP  '['
+#define DN  ']'
+#define ENT '\n'
+#define DEL '\b'
+
+int putchar_lcd(int c);
+int printf_lcd(const char *format, ...);
+char getkey(void);
+int getchar_keypad(void);
+char *fgets_keypad(char *buffer, int bufferlen);
+double double_in(char *prompt);
+
+#endif
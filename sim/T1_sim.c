@@ -0,0 +1,144 @@
+/*
+ * T1_sim.c
+ * Author: Trenton
+ * Date: 03/21/25
+ * Description: Simulated T1 library routines for host builds. They follow
+ * the lab versions (main-1.c, main-2.c, main-3.c) but wait on the virtual
+ * clock instead of busy loops. All are weak so a lab's own definitions win.
+ *
+ * getkey() returns DEL once the keypad script has run out, so a lab that
+ * loops until "<-" still ends when the script is done.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdarg.h>
+#include "MyRio.h"
+#include "T1.h"
+#include "ctable2.h"
+
+#define SIM_WEAK __attribute__((weak))
+#define SIM_SCAN_NS (5 * SIM_NS_PER_MS)	// keypad rescan period
+
+// Functions ###################################################################
+
+SIM_WEAK int putchar_lcd(int c){
+/* same escape translation as main-3.c */
+	static MyRio_Uart uart;
+	static int i = 0;
+	uint8_t d[2];
+	int n = 1;
+
+	if (i == 0){
+		uart.name = "ASRL2::INSTR";
+		uart.defaultRM = 0;
+		uart.session = 0;
+		if (Uart_Open(&uart, 19200, 8, Uart_StopBits1_0, Uart_ParityNone) < VI_SUCCESS){
+			return EOF;
+		}
+		i = 1;
+	}
+	if (c > 255 || c < 0) return EOF;
+	d[0] = (uint8_t)c;
+	if (c == '\n') d[0] = 13;
+	if (c == '\f'){
+		d[1] = 17;
+		n = 2;
+	}
+	if (Uart_Write(&uart, d, n) < VI_SUCCESS) return EOF;
+	return c;
+}
+
+SIM_WEAK int printf_lcd(const char *format, ...){
+	int n;
+	char string[80];
+	char *p = string;
+	va_list args;
+	va_start(args, format);
+	n = vsnprintf(string, 80, format, args);
+	va_end(args);
+	if (n <= 0) return -1;
+	while (*p) putchar_lcd(*p++);
+	return n;
+}
+
+SIM_WEAK char getkey(void){
+/* column scan as in main-3.c, rescans every 5 ms of virtual time */
+	const char table[4][4] = {
+			{'1', '2', '3', UP},
+			{'4', '5', '6', DN},
+			{'7', '8', '9', ENT},
+			{'0', '.', '-', DEL}
+	};
+	MyRio_Dio ch[8];
+	int i, c, r;
+
+	for (i = 0; i < 8; i++){
+		ch[i].dir = DIOB_70DIR;
+		ch[i].out = DIOB_70OUT;
+		ch[i].in = DIOB_70IN;
+		ch[i].bit = i;
+	}
+	while (1){
+		if (sim_keypad_pending() == 0) return DEL;	// script is done
+		for (c = 0; c < 4; c++){
+			for (i = 0; i < 4; i++) Dio_ReadBit(&ch[i]);
+			Dio_WriteBit(&ch[c], NiFpga_False);
+			for (r = 4; r < 8; r++){
+				if (Dio_ReadBit(&ch[r]) == NiFpga_False){
+					// wait for release
+					while (Dio_ReadBit(&ch[r]) == NiFpga_False) sim_advance(SIM_SCAN_NS);
+					return table[r-4][c];
+				}
+			}
+		}
+		sim_advance(SIM_SCAN_NS);
+	}
+}
+
+SIM_WEAK char *fgets_keypad(char *buffer, int bufferlen){
+/* collects keys until ENT, DEL removes the previous key */
+	int n = 0;
+	char c;
+	while ((c = getkey()) != ENT){
+		if (c == DEL){
+			if (n == 0 && sim_keypad_pending() == 0) break;
+			if (n > 0){
+				n--;
+				putchar_lcd('\b'); putchar_lcd(' '); putchar_lcd('\b');
+			}
+		}
+		else if (n < bufferlen - 1){
+			buffer[n++] = c;
+			putchar_lcd(c);
+		}
+	}
+	buffer[n] = '\0';
+	return buffer;
+}
+
+SIM_WEAK double double_in(char *prompt){
+	char buffer[40];
+	double value = 0;
+	putchar_lcd('\f');
+	printf_lcd(prompt);
+	fgets_keypad(buffer, 40);
+	sscanf(buffer, "%lf", &value);
+	return value;
+}
+
+SIM_WEAK int ctable2(char *title, table *entries, int nval){
+/* minimal table editor: UP/DN select, ENT edits, DEL returns */
+	int sel = 0;
+	char c;
+	while (1){
+		printf_lcd("\f%s\n%s%g", title, entries[sel].e_label, entries[sel].value);
+		c = getkey();
+		if (c == DEL) return 0;
+		if (c == UP && sel > 0) sel--;
+		if (c == DN && sel < nval-1) sel++;
+		if (c == ENT && entries[sel].e_type == 1){
+			entries[sel].value = double_in(entries[sel].e_label);
+		}
+	}
+}
@@ -0,0 +1,24 @@
+/*
+ * TimerIRQ.h (host simulation)
+ * Timer interrupt. Writing IRQTIMERWRITE then IRQTIMERSETTIME arms the
+ * timer for that many microseconds after the current virtual time.
+ */
+
+#ifndef MYRIO_SIM_TIMERIRQ_H
+#define MYRIO_SIM_TIMERIRQ_H
+
+#include "IRQConfigure.h"
+
+#define TIMERIRQNO 0
+
+typedef struct {
+	uint32_t timerWrite;	// timeout register
+	uint32_t timerSet;		// arm register
+} MyRio_IrqTimer;
+
+int32_t Irq_RegisterTimerIrq(MyRio_IrqTimer *irqChannel,
+		NiFpga_IrqContext *irqContext, uint32_t timeout);
+int32_t Irq_UnregisterTimerIrq(MyRio_IrqTimer *irqChannel,
+		NiFpga_IrqContext irqContext);
+
+#endif
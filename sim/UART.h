@@ -0,0 +1,37 @@
+/*
+ * UART.h (host simulation)
+ * Every Uart_Write goes to the sink set with sim_uart_sink() and costs
+ * virtual time: a fixed per-call overhead plus 10 bit times per byte.
+ */
+
+#ifndef MYRIO_SIM_UART_H
+#define MYRIO_SIM_UART_H
+
+#include "MyRio.h"
+
+#define VI_SUCCESS 0
+
+typedef enum {
+	Uart_StopBits1_0 = 10,
+	Uart_StopBits2_0 = 20
+} Uart_StopBits;
+
+typedef enum {
+	Uart_ParityNone = 0,
+	Uart_ParityOdd,
+	Uart_ParityEven
+} Uart_Parity;
+
+typedef struct {
+	const char *name;	// VISA resource name
+	uint32_t defaultRM;	// resource manager
+	uint32_t session;	// session reference number
+} MyRio_Uart;
+
+int32_t Uart_Open(MyRio_Uart *port, uint32_t baud, uint8_t dataBits,
+		Uart_StopBits stopBits, Uart_Parity parity);
+int32_t Uart_Write(MyRio_Uart *port, const uint8_t *data, uint32_t nData);
+int32_t Uart_Clear(MyRio_Uart *port);
+int32_t Uart_Close(MyRio_Uart *port);
+
+#endif
@@ -0,0 +1,17 @@
+/*
+ * ctable2.h (host simulation)
+ * Table editor used by Lab 7.
+ */
+
+#ifndef MYRIO_SIM_CTABLE2_H
+#define MYRIO_SIM_CTABLE2_H
+
+typedef struct {
+	char *e_label;	// entry label label
+	int e_type;		// entry type (0-show; 1-edit)
+	double value;	// value
+} table;
+
+int ctable2(char *title, table *entries, int nval);
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * matlabfiles.c
+ * Author: Trenton
+ * Date: 03/21/25
+ * Description: MAT-file level 5 writer for host builds, same calls as the
+ * target matlabfiles library. Matrices are written as double, strings as
+ * 1xN char arrays.
+ *
+ * Each variable is one miMATRIX element:
+ * 	array flags, dimensions, name, real part
+ * and every sub-element is padded to 8 bytes.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "matlabfiles.h"
+
+/* definitions */
+#define miINT8   1
+#define miUINT16 4
+#define miINT32  5
+#define miUINT32 6
+#define miDOUBLE 9
+#define miMATRIX 14
+#define mxCHAR_CLASS   4
+#define mxDOUBLE_CLASS 6
+
+/* prototypes */
+static void put_tag(FILE *fp, uint32_t type, uint32_t nbytes);
+static void put_pad(FILE *fp, uint32_t nbytes);
+static uint32_t padded(uint32_t nbytes);
+static void put_header(FILE *fp, const char *name, uint32_t cls,
+		int m, int n, uint32_t data_bytes);
+
+// Functions ###################################################################
+
+static uint32_t padded(uint32_t nbytes){
+	return (nbytes + 7) & ~7u;
+}
+
+static void put_tag(FILE *fp, uint32_t type, uint32_t nbytes){
+	fwrite(&type, 4, 1, fp);
+	fwrite(&nbytes, 4, 1, fp);
+}
+
+static void put_pad(FILE *fp, uint32_t nbytes){
+	static const uint8_t zero[8] = {0};
+	fwrite(zero, 1, padded(nbytes) - nbytes, fp);
+}
+
+static void put_header(FILE *fp, const char *name, uint32_t cls,
+		int m, int n, uint32_t data_bytes){
+/* miMATRIX tag and every sub-element up to the data tag */
+	uint32_t len = (uint32_t)strlen(name);
+	uint32_t flags[2] = {cls, 0};
+	int32_t dims[2] = {m, n};
+	uint32_t total = 16 + 16 + 8 + padded(len) + 8 + padded(data_bytes);
+
+	put_tag(fp, miMATRIX, total);
+	put_tag(fp, miUINT32, 8);
+	fwrite(flags, 4, 2, fp);
+	put_tag(fp, miINT32, 8);
+	fwrite(dims, 4, 2, fp);
+	put_tag(fp, miINT8, len);
+	fwrite(name, 1, len, fp);
+	put_pad(fp, len);
+}
+
+MATFILE *openmatfile(char *fname, int *err){
+/* opens fname and writes the 128 byte header, err is set to 0 on success */
+	char text[116];
+	uint8_t tail[12] = {0};
+	MATFILE *mf = malloc(sizeof(MATFILE));
+
+	if (!mf){
+		if (err) *err = 1;
+		return NULL;
+	}
+	mf->fp = fopen(fname, "wb");
+	if (!mf->fp){
+		if (err) *err = 2;
+		free(mf);
+		return NULL;
+	}
+	memset(text, ' ', sizeof(text));
+	memcpy(text, "MATLAB 5.0 MAT-file, myRIO host", 31);
+	fwrite(text, 1, sizeof(text), mf->fp);
+	tail[8] = 0x00; tail[9] = 0x01;		// version 0x0100
+	tail[10] = 'I'; tail[11] = 'M';		// little endian
+	fwrite(tail, 1, sizeof(tail), mf->fp);
+	if (err) *err = 0;
+	return mf;
+}
+
+int matfile_addstring(MATFILE *mf, char *name, char *str){
+	uint32_t n = (uint32_t)strlen(str);
+	uint32_t i;
+	if (!mf) return -1;
+	put_header(mf->fp, name, mxCHAR_CLASS, 1, (int)n, 2*n);
+	put_tag(mf->fp, miUINT16, 2*n);
+	for (i = 0; i < n; i++){
+		uint16_t c = (uint8_t)str[i];
+		fwrite(&c, 2, 1, mf->fp);
+	}
+	put_pad(mf->fp, 2*n);
+	return 0;
+}
+
+int matfile_addmatrix(MATFILE *mf, char *name, double *data, int m, int n,
+		int transpose){
+/* data is column major (MATLAB order), or row major if transpose is set */
+	uint32_t nbytes = (uint32_t)(m*n) * 8;
+	int i, j;
+	if (!mf) return -1;
+	put_header(mf->fp, name, mxDOUBLE_CLASS, m, n, nbytes);
+	put_tag(mf->fp, miDOUBLE, nbytes);
+	if (!transpose){
+		fwrite(data, 8, (size_t)m*n, mf->fp);
+	}
+	else{
+		for (j = 0; j < n; j++){
+			for (i = 0; i < m; i++) fwrite(&data[i*n + j], 8, 1, mf->fp);
+		}
+	}
+	return 0;
+}
+
+int matfile_close(MATFILE *mf){
+	int r;
+	if (!mf) return -1;
+	r = fclose(mf->fp);
+	free(mf);
+	return r;
+}
@@ -0,0 +1,21 @@
+/*
+ * matlabfiles.h (host simulation)
+ * Writes MATLAB level 5 MAT files with the same calls as the target library.
+ */
+
+#ifndef MYRIO_SIM_MATLABFILES_H
+#define MYRIO_SIM_MATLABFILES_H
+
+#include <stdio.h>
+
+typedef struct {
+	FILE *fp;	// open file
+} MATFILE;
+
+MATFILE *openmatfile(char *fname, int *err);
+int matfile_addstring(MATFILE *mf, char *name, char *str);
+int matfile_addmatrix(MATFILE *mf, char *name, double *data, int m, int n,
+		int transpose);
+int matfile_close(MATFILE *mf);
+
+#endif
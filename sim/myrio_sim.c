@@ -0,0 +1,1089 @@
+/*
+ * myrio_sim.c
+ * Author: Trenton
+ * Date: 03/21/25
+ * Description: Host-side simulated myRIO. Implements the FPGA, DIO, AIO,
+ * UART, encoder and IRQ calls used by the labs on top of a virtual clock,
+ * so the lab code can run on a Linux box faster than real time and with
+ * timing that repeats from run to run. See myrio_sim.h for the controls.
+ *
+ * All simulation state is behind one mutex, the ISR thread and the main
+ * thread can both call in. The UART sink is called without the lock held.
+ *
+ * Threads take turns on the virtual clock. A sleep, a sim_sem_wait(), a
+ * sim_join() and the start of a thread from sim_thread_register() block
+ * the calling thread in the simulation, and so does Irq_Wait(). Once every
+ * known thread is blocked, step() lets one go: an ISR whose event is due
+ * goes first, then the first waiter that is due, and if none is the clock
+ * jumps to the earliest wake time or event. A register access moves the
+ * clock right away but stops at each pending IRQ event on the way until
+ * its ISR thread has taken it. A thread becomes the service thread of an
+ * IRQ on its first Irq_Wait() for it.
+ *
+ * Which events are taken, and when, depends only on this state, never on
+ * how long a thread takes in real time. A thread is known from its first
+ * call into the simulation, or from sim_thread_register(), until it exits
+ * or calls sim_thread_unregister(). The waits only use real time to look
+ * at a stop flag the simulation can't see being set, and to stop the run
+ * loudly if the clock can't move any more.
+ */
+
+/* includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "MyRio.h"
+#include "DIO.h"
+#include "AIO.h"
+#include "UART.h"
+#include "Encoder.h"
+#include "TimerIRQ.h"
+#include "DIIRQ.h"
+#include "T1.h"
+
+/* definitions */
+#define SIM_MAX_EVENTS 256		// scripted events of each kind
+#define SIM_COUNTS_PER_REV 2048.0	// encoder counts per revolution
+#define SIM_AIO_RANGE 10.0		// +-10 V
+#define SIM_AIO_STEP (2.0*SIM_AIO_RANGE/4096.0)	// 12 bit ADC step
+#define SIM_POLL_NS 1000000L	// real time between looks at a stop flag
+#define SIM_STALL_S 10			// real time the clock may stand still in a wait
+#define SIM_MAX_WAITERS 16		// threads blocked outside Irq_Wait() at once
+#define SIM_MAX_THREADS 16		// known threads
+
+typedef struct {
+	uint64_t t0, t1;	// pressed from t0 until t1
+	int row, col;		// keypad matrix position
+} KeyPress;
+
+typedef struct {
+	uint64_t t;		// time of change
+	int bank, bit;	// pin
+	int level;		// new level
+} LevelChange;
+
+typedef struct {
+	uint64_t t;		// time of edge
+	uint8_t irq;	// IRQ number
+} DiEdge;
+
+typedef enum { W_FREE, W_SLEEP, W_SEM, W_JOIN } WaitKind;
+
+typedef struct {
+	WaitKind kind;		// W_FREE: slot not in use
+	int due;			// W_SEM: posted, W_JOIN: the thread has gone
+	int run;			// let go by step()
+	uint64_t t;			// W_SLEEP: wake time
+	sem_t *sem;			// W_SEM: semaphore waited on
+	pthread_t join;		// W_JOIN: thread waited for
+} Waiter;
+
+typedef struct {
+	uint64_t gen, now;	// sync state and clock when last seen moving
+	time_t since;		// real time (s) they were seen
+} Stall;
+
+/* simulation state */
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_cond = PTHREAD_COND_INITIALIZER;	// IRQ delivered
+static uint64_t now_ns;						// virtual clock
+static uint64_t access_cost = 2 * SIM_NS_PER_US;
+static uint64_t access_count;
+static uint32_t regs[SIM_NUM_REGS];			// register file
+__attribute__((weak)) NiFpga_Session myrio_session;	// a lab's own one wins
+
+static KeyPress keys[SIM_MAX_EVENTS];
+static int nkeys;
+static LevelChange levels[SIM_MAX_EVENTS];
+static int nlevels;
+static DiEdge edges[SIM_MAX_EVENTS];		// sorted by time
+static int nedges;
+static int next_edge;
+
+static int timer_armed;
+static uint64_t timer_deadline;
+static int di_registered[SIM_NUM_IRQS];
+static uint64_t irq_counts[SIM_NUM_IRQS];
+static uint64_t sim_gen;					// bumped on every sync state change
+static int irq_thread_set[SIM_NUM_IRQS];	// service thread known
+static pthread_t irq_thread[SIM_NUM_IRQS];	// service thread of each IRQ
+static pthread_t known_ids[SIM_MAX_THREADS];	// known threads, in no order
+static int threads_known;					// of those in use
+static int threads_blocked;					// known threads blocked in the simulation
+static int isr_running;						// ISR threads outside Irq_Wait()
+static Waiter waiters[SIM_MAX_WAITERS];		// blocked threads outside Irq_Wait()
+static pthread_key_t thread_key;			// runs thread_gone() at thread exit
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static __thread int thread_known;
+static __thread int isr_body;				// this thread is an ISR outside Irq_Wait()
+
+static sim_uart_fn uart_fn;
+static void *uart_ctx;
+static uint32_t uart_baud = 19200;
+static uint64_t uart_call_cost = 50 * SIM_NS_PER_US;
+static uint64_t uart_bytes;
+static uint64_t uart_calls;
+
+static sim_signal_fn aio_fn[SIM_AIO_COUNT];
+static void *aio_ctx[SIM_AIO_COUNT];
+static double aio_out[SIM_AIO_COUNT];
+
+static sim_count_fn enc_fn[SIM_NUM_ENCODERS];
+static void *enc_ctx[SIM_NUM_ENCODERS];
+
+static int motor_on;
+static Sim_Motor motor;
+static double motor_rpm;		// current speed
+static double motor_counts;		// accumulated encoder counts
+static uint64_t motor_t;		// time of last motor update
+
+// keypad layout, same table as getkey()
+static const char key_table[4][4] = {
+		{'1', '2', '3', UP},
+		{'4', '5', '6', DN},
+		{'7', '8', '9', ENT},
+		{'0', '.', '-', DEL}
+};
+
+/* prototypes */
+static void tick(int accesses);
+static void advance_locked(uint64_t target);
+static void sync_changed(void);
+static void thread_enter(void);
+static void thread_leave(void);
+static void sleep_locked(uint64_t t);
+static void step(void);
+static int irq_event(uint8_t irq, uint64_t *t);
+static int next_event(int mine, uint64_t *t);
+static int dio_level(int bank, int bit);
+static double motor_drive(void);
+static void motor_update(void);
+
+// Functions ###################################################################
+
+/* virtual clock ---------------------------------------------------------------*/
+uint64_t sim_now(void){
+	uint64_t t;
+	pthread_mutex_lock(&sim_lock);
+	t = now_ns;
+	pthread_mutex_unlock(&sim_lock);
+	return t;
+}
+
+void sim_advance(uint64_t ns){
+	pthread_mutex_lock(&sim_lock);
+	sleep_locked(now_ns + ns);
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_advance_to(uint64_t t_ns){
+	pthread_mutex_lock(&sim_lock);
+	sleep_locked(t_ns);
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_set_access_cost(uint64_t ns){
+	pthread_mutex_lock(&sim_lock);
+	access_cost = ns;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+uint64_t sim_access_count(void){
+	uint64_t n;
+	pthread_mutex_lock(&sim_lock);
+	n = access_count;
+	pthread_mutex_unlock(&sim_lock);
+	return n;
+}
+
+uint64_t sim_irq_count(uint8_t irqNumber){
+	uint64_t n = 0;
+	pthread_mutex_lock(&sim_lock);
+	if (irqNumber < SIM_NUM_IRQS) n = irq_counts[irqNumber];
+	pthread_mutex_unlock(&sim_lock);
+	return n;
+}
+
+static void tick(int accesses){
+/* charge register accesses to the virtual clock, lock held */
+	access_count += accesses;
+	advance_locked(now_ns + access_cost * accesses);
+}
+
+static void deadline_in(struct timespec *limit, long ns){
+/* real time ns from now, for pthread_cond_timedwait() */
+	clock_gettime(CLOCK_REALTIME, limit);
+	limit->tv_nsec += ns;
+	while (limit->tv_nsec >= 1000000000L){
+		limit->tv_sec++;
+		limit->tv_nsec -= 1000000000L;
+	}
+}
+
+static void stall_start(Stall *s){
+/* lock held */
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	s->gen = sim_gen;
+	s->now = now_ns;
+	s->since = ts.tv_sec;
+}
+
+static void wait_locked(Stall *s, const char *who){
+/* one wait on sim_cond of at most SIM_POLL_NS, lock held
+ * If neither the sync state nor the clock has moved in SIM_STALL_S, every
+ * thread that could move it is waiting on another one: a deadlock, or a
+ * thread spinning without calling into the simulation. */
+	struct timespec limit;
+	deadline_in(&limit, SIM_POLL_NS);
+	pthread_cond_timedwait(&sim_cond, &sim_lock, &limit);
+	if (sim_gen != s->gen || now_ns != s->now){
+		stall_start(s);
+	}
+	else if (limit.tv_sec - s->since >= SIM_STALL_S){
+		fprintf(stderr, "myrio_sim: %s: clock stuck at %llu ns for %d s"
+				" (%d of %d threads blocked, %d ISRs running)\n", who,
+				(unsigned long long)now_ns, SIM_STALL_S, threads_blocked,
+				threads_known, isr_running);
+		abort();
+	}
+}
+
+void sim_wait_until(uint64_t t_ns, atomic_int *run){
+/* for background threads that run every so often of virtual time but
+ * shouldn't move it, e.g. a telemetry writer: one that advanced the clock
+ * to its own deadlines would run it ahead of the lab's threads whenever
+ * they are busy outside the simulation. Returns early once *run is 0,
+ * looked at every SIM_POLL_NS of real time. */
+	struct timespec limit;
+	pthread_mutex_lock(&sim_lock);
+	while (now_ns < t_ns && atomic_load(run)){
+		deadline_in(&limit, SIM_POLL_NS);
+		pthread_cond_timedwait(&sim_cond, &sim_lock, &limit);
+	}
+	pthread_mutex_unlock(&sim_lock);
+}
+
+static int known_index(pthread_t t){
+/* slot of t in known_ids[], -1 if it isn't a known thread, lock held */
+	int i;
+	for (i = 0; i < threads_known; i++){
+		if (pthread_equal(known_ids[i], t)) return i;
+	}
+	return -1;
+}
+
+static void thread_gone(void *p){
+/* a known thread has exited, it no longer holds the clock back */
+	pthread_mutex_lock(&sim_lock);
+	thread_leave();
+	pthread_mutex_unlock(&sim_lock);
+}
+
+static void make_key(void){
+	pthread_key_create(&thread_key, thread_gone);
+}
+
+static void thread_enter(void){
+/* count the calling thread, running, if it isn't yet, lock held */
+	if (thread_known) return;
+	if (threads_known == SIM_MAX_THREADS){
+		fprintf(stderr, "myrio_sim: more than %d threads\n", SIM_MAX_THREADS);
+		abort();
+	}
+	pthread_once(&key_once, make_key);
+	pthread_setspecific(thread_key, &thread_known);
+	thread_known = 1;
+	known_ids[threads_known++] = pthread_self();
+	sync_changed();
+}
+
+static void thread_leave(void){
+/* stop counting the calling thread, a sim_join() on it can go on, lock held */
+	int i;
+	if (!thread_known) return;
+	pthread_setspecific(thread_key, NULL);
+	thread_known = 0;
+	i = known_index(pthread_self());
+	known_ids[i] = known_ids[--threads_known];
+	if (isr_body){
+		isr_body = 0;
+		isr_running--;
+	}
+	for (i = 0; i < SIM_NUM_IRQS; i++){
+		if (irq_thread_set[i] && pthread_equal(irq_thread[i], pthread_self())){
+			irq_thread_set[i] = 0;
+		}
+	}
+	for (i = 0; i < SIM_MAX_WAITERS; i++){
+		if (waiters[i].kind == W_JOIN && pthread_equal(waiters[i].join, pthread_self())){
+			waiters[i].due = 1;
+		}
+	}
+	sync_changed();
+}
+
+static int waiter_new(WaitKind kind){
+/* a free waiter slot for the calling thread, blocked from here on, lock held */
+	int i;
+	for (i = 0; i < SIM_MAX_WAITERS && waiters[i].kind != W_FREE; i++){}
+	if (i == SIM_MAX_WAITERS){
+		fprintf(stderr, "myrio_sim: more than %d threads blocked\n", SIM_MAX_WAITERS);
+		abort();
+	}
+	waiters[i].kind = kind;
+	waiters[i].due = 0;
+	waiters[i].run = 0;
+	threads_blocked++;
+	sync_changed();
+	return i;
+}
+
+static void waiter_wait(int i, const char *who){
+/* wait in slot i until step() lets the thread go, then free it, lock held */
+	Stall s;
+	stall_start(&s);
+	while (1){
+		step();
+		if (waiters[i].run) break;
+		wait_locked(&s, who);
+	}
+	waiters[i].kind = W_FREE;
+}
+
+static int waiter_due(const Waiter *w){
+	return w->kind == W_SLEEP ? w->t <= now_ns : w->due;
+}
+
+static void step(void){
+/* let the next blocked thread go once every known thread is blocked, lock held
+ * An IRQ event that is due is left to its ISR thread in Irq_Wait().
+ * Otherwise the first waiter slot that is due goes, or if none is the clock
+ * jumps to the earliest sleep end or event and that is tried again. Only
+ * one thread goes at a time, so the order never depends on which host
+ * thread gets the lock first. */
+	uint64_t t;
+	int i, found;
+
+	if (threads_blocked < threads_known) return;
+	while (1){
+		if (next_event(1, &t) && t <= now_ns) return;
+		for (i = 0; i < SIM_MAX_WAITERS; i++){
+			if (waiters[i].kind != W_FREE && !waiters[i].run && waiter_due(&waiters[i])){
+				waiters[i].run = 1;
+				threads_blocked--;
+				sync_changed();
+				return;
+			}
+		}
+		found = next_event(1, &t);
+		for (i = 0; i < SIM_MAX_WAITERS; i++){
+			if (waiters[i].kind == W_SLEEP && !waiters[i].run && (!found || waiters[i].t < t)){
+				t = waiters[i].t;
+				found = 1;
+			}
+		}
+		if (!found) return;		// only a post from outside can end this
+		now_ns = t;
+		motor_update();
+		sync_changed();
+	}
+}
+
+static void sleep_locked(uint64_t t){
+/* sleep until t on the virtual clock, lock held
+ * An ISR in its service body keeps the clock to itself, so it moves it
+ * like a register access. */
+	int i;
+	thread_enter();
+	if (isr_body){
+		advance_locked(t);
+		return;
+	}
+	if (t <= now_ns) return;
+	i = waiter_new(W_SLEEP);
+	waiters[i].t = t;
+	waiter_wait(i, "sleep");
+}
+
+void sim_thread_register(int isr, sem_t *ready){
+/* first call of a new thread, posts ready for its creator
+ * isr = 1: it runs as an ISR body until its first Irq_Wait(). isr = 0: it
+ * starts blocked and runs when step() lets it go, at a set virtual time. */
+	int i;
+	pthread_mutex_lock(&sim_lock);
+	thread_enter();
+	if (isr){
+		isr_body = 1;
+		isr_running++;
+		sync_changed();
+		sem_post(ready);
+	}
+	else{
+		i = waiter_new(W_SLEEP);
+		waiters[i].t = now_ns;
+		sem_post(ready);
+		waiter_wait(i, "start");
+	}
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_thread_unregister(void){
+	pthread_mutex_lock(&sim_lock);
+	thread_leave();
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_sem_wait(sem_t *s){
+/* sem_wait() as a wait in the simulation
+ * If s has to be waited on, the thread is blocked until sim_sem_post() on
+ * s makes it due and step() lets it go, so it runs at the virtual time of
+ * the post however long the host takes to schedule it. */
+	int i;
+	pthread_mutex_lock(&sim_lock);
+	thread_enter();
+	if (sem_trywait(s) == 0){	// not blocked, still running
+		pthread_mutex_unlock(&sim_lock);
+		return;
+	}
+	i = waiter_new(W_SEM);
+	waiters[i].sem = s;
+	pthread_mutex_unlock(&sim_lock);
+
+	while (sem_wait(s) != 0){}	// retry if interrupted
+	pthread_mutex_lock(&sim_lock);
+	waiters[i].due = 1;			// also after a plain sem_post()
+	waiter_wait(i, "sim_sem_wait");
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_sem_post(sem_t *s){
+/* sem_post() that makes the first thread in sim_sem_wait() on s due */
+	int i;
+	pthread_mutex_lock(&sim_lock);
+	for (i = 0; i < SIM_MAX_WAITERS; i++){
+		if (waiters[i].kind == W_SEM && waiters[i].sem == s && !waiters[i].due){
+			waiters[i].due = 1;
+			sync_changed();
+			break;
+		}
+	}
+	sem_post(s);
+	pthread_mutex_unlock(&sim_lock);
+}
+
+int sim_join(pthread_t t){
+/* pthread_join() as a wait in the simulation when t is a known thread */
+	int i, r;
+	pthread_mutex_lock(&sim_lock);
+	if (!thread_known || known_index(t) < 0){
+		pthread_mutex_unlock(&sim_lock);
+		return pthread_join(t, NULL);
+	}
+	i = waiter_new(W_JOIN);
+	waiters[i].join = t;
+	pthread_mutex_unlock(&sim_lock);
+
+	r = pthread_join(t, NULL);
+	pthread_mutex_lock(&sim_lock);
+	waiters[i].due = 1;
+	waiter_wait(i, "sim_join");
+	pthread_mutex_unlock(&sim_lock);
+	return r;
+}
+
+static int irq_event(uint8_t irq, uint64_t *t){
+/* time of the next pending event for irq, 0 if there is none, lock held */
+	int i;
+	if (irq == TIMERIRQNO){
+		if (!timer_armed) return 0;
+		*t = timer_deadline;
+		return 1;
+	}
+	if (!di_registered[irq]) return 0;
+	for (i = next_edge; i < nedges; i++){
+		if (edges[i].irq == irq){
+			*t = edges[i].t;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int next_event(int mine, uint64_t *t){
+/* earliest pending event of an IRQ with a service thread, lock held
+ * mine = 0: serviced by another thread, mine = 1: any thread.
+ * Returns 0 if there is none. An IRQ nobody waits on yet doesn't hold the
+ * clock, its events are taken late by the first Irq_Wait(). */
+	pthread_t self = pthread_self();
+	uint64_t ev;
+	int irq, found = 0;
+
+	for (irq = 0; irq < SIM_NUM_IRQS; irq++){
+		if (!irq_thread_set[irq]) continue;
+		if (!mine && pthread_equal(irq_thread[irq], self)) continue;
+		if (irq_event(irq, &ev) && (!found || ev < *t)){
+			*t = ev;
+			found = 1;
+		}
+	}
+	return found;
+}
+
+static void sync_changed(void){
+/* wake every thread waiting on the sync state, lock held */
+	sim_gen++;
+	pthread_cond_broadcast(&sim_cond);
+}
+
+static void advance_locked(uint64_t target){
+/* move the clock to target for register accesses, lock held
+ * A thread that is not an ISR waits while any ISR is in its service body,
+ * since the ISR may still schedule an event, and stops at each pending IRQ
+ * event on the way until its ISR thread has taken it. */
+	uint64_t ev = 0, seen;
+	Stall s;
+
+	thread_enter();
+	motor_update();
+	stall_start(&s);
+	while (1){
+		if (!isr_body && isr_running > 0){
+			// wait for the ISR to get back to Irq_Wait()
+		}
+		else if (next_event(0, &ev) && ev <= target){
+			if (ev > now_ns){
+				now_ns = ev;
+				motor_update();
+			}
+		}
+		else break;
+		sync_changed();		// the clock moved, ISRs check their events
+		seen = sim_gen;
+		while (seen == sim_gen) wait_locked(&s, "advance");
+	}
+	if (target > now_ns){
+		now_ns = target;
+		motor_update();
+	}
+}
+
+void sim_reset(void){
+/* clears every script, source and counter and sets the clock back to 0 */
+	pthread_mutex_lock(&sim_lock);
+	now_ns = 0;
+	access_cost = 2 * SIM_NS_PER_US;
+	access_count = 0;
+	memset(regs, 0, sizeof(regs));
+	nkeys = nlevels = nedges = next_edge = 0;
+	timer_armed = 0;
+	memset(di_registered, 0, sizeof(di_registered));
+	memset(irq_counts, 0, sizeof(irq_counts));
+	memset(irq_thread_set, 0, sizeof(irq_thread_set));
+	uart_fn = NULL;
+	uart_ctx = NULL;
+	uart_call_cost = 50 * SIM_NS_PER_US;
+	uart_bytes = uart_calls = 0;
+	memset(aio_fn, 0, sizeof(aio_fn));
+	memset(aio_ctx, 0, sizeof(aio_ctx));
+	memset(aio_out, 0, sizeof(aio_out));
+	memset(enc_fn, 0, sizeof(enc_fn));
+	memset(enc_ctx, 0, sizeof(enc_ctx));
+	motor_on = 0;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+/* scripts ---------------------------------------------------------------------*/
+void sim_keypad_press(char key, uint64_t at_ns, uint64_t hold_ns){
+	int r, c;
+	pthread_mutex_lock(&sim_lock);
+	for (r = 0; r < 4; r++){
+		for (c = 0; c < 4; c++){
+			if (key_table[r][c] == key && nkeys < SIM_MAX_EVENTS){
+				keys[nkeys].t0 = at_ns;
+				keys[nkeys].t1 = at_ns + hold_ns;
+				keys[nkeys].row = r;
+				keys[nkeys].col = c;
+				nkeys++;
+			}
+		}
+	}
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_keypad_type(const char *keys_in, uint64_t start_ns, uint64_t gap_ns,
+		uint64_t hold_ns){
+	uint64_t t = start_ns;
+	while (*keys_in){
+		sim_keypad_press(*keys_in++, t, hold_ns);
+		t += gap_ns;
+	}
+}
+
+int sim_keypad_pending(void){
+/* number of scripted key presses that have not been released yet */
+	int i, n = 0;
+	pthread_mutex_lock(&sim_lock);
+	for (i = 0; i < nkeys; i++){
+		if (keys[i].t1 > now_ns) n++;
+	}
+	pthread_mutex_unlock(&sim_lock);
+	return n;
+}
+
+void sim_dio_level(int bank, int bit, uint64_t at_ns, int level){
+	pthread_mutex_lock(&sim_lock);
+	if (nlevels < SIM_MAX_EVENTS){
+		levels[nlevels].t = at_ns;
+		levels[nlevels].bank = bank;
+		levels[nlevels].bit = bit;
+		levels[nlevels].level = level;
+		nlevels++;
+	}
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_di_edge(uint8_t irqNumber, uint64_t at_ns){
+	int i;
+	pthread_mutex_lock(&sim_lock);
+	if (nedges < SIM_MAX_EVENTS){
+		// insertion keeps the list sorted by time
+		for (i = nedges; i > next_edge && edges[i-1].t > at_ns; i--){
+			edges[i] = edges[i-1];
+		}
+		edges[i].t = at_ns;
+		edges[i].irq = irqNumber;
+		nedges++;
+	}
+	pthread_mutex_unlock(&sim_lock);
+}
+
+/* FPGA session and registers --------------------------------------------------*/
+NiFpga_Status MyRio_Open(void){
+/* the simulation is always open, scripts set before this call are kept */
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status MyRio_Close(void){
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_WriteU32(NiFpga_Session session, uint32_t reg, uint32_t value){
+	if (reg >= SIM_NUM_REGS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	regs[reg] = value;
+	pthread_mutex_unlock(&sim_lock);
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_WriteBool(NiFpga_Session session, uint32_t reg, NiFpga_Bool value){
+	if (reg >= SIM_NUM_REGS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	regs[reg] = value;
+	// arming the timer starts the timeout from now
+	if (reg == IRQTIMERSETTIME && value){
+		timer_deadline = now_ns + (uint64_t)regs[IRQTIMERWRITE] * SIM_NS_PER_US;
+		timer_armed = 1;
+	}
+	pthread_mutex_unlock(&sim_lock);
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_ReadU32(NiFpga_Session session, uint32_t reg, uint32_t *value){
+	if (reg >= SIM_NUM_REGS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	*value = regs[reg];
+	pthread_mutex_unlock(&sim_lock);
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_ReadBool(NiFpga_Session session, uint32_t reg, NiFpga_Bool *value){
+	if (reg >= SIM_NUM_REGS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	*value = regs[reg] ? NiFpga_True : NiFpga_False;
+	pthread_mutex_unlock(&sim_lock);
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_WriteU8(NiFpga_Session session, uint32_t reg, uint8_t value){
+	if (reg >= SIM_NUM_REGS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	// the motor sees the old drive up to now
+	if (motor_on && motor.aio_chan < 0 && reg <= DIOC_70IN && reg / 3 == motor.bank){
+		motor_update();
+	}
+	tick(1);
+	regs[reg] = value;
+	pthread_mutex_unlock(&sim_lock);
+	return NiFpga_Status_Success;
+}
+
+NiFpga_Status NiFpga_ReadU8(NiFpga_Session session, uint32_t reg, uint8_t *value){
+	int bit;
+	if (reg >= SIM_NUM_REGS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	if (reg <= DIOC_70IN && reg % 3 == 2){		// a DIO bank's input register
+		*value = 0;
+		for (bit = 0; bit < 8; bit++){
+			if (dio_level(reg / 3, bit)) *value |= (uint8_t)(1u << bit);
+		}
+	}
+	else *value = (uint8_t)regs[reg];
+	pthread_mutex_unlock(&sim_lock);
+	return NiFpga_Status_Success;
+}
+
+/* DIO -------------------------------------------------------------------------*/
+static int dio_level(int bank, int bit){
+/* level seen on an input pin at the current time, lock held
+ * Outputs read back their own value. Keypad rows on connector B read low
+ * when a scripted key is held and its column is driven low. Otherwise the
+ * latest scripted level is used, or the pull resistor: up on A/B, down on C. */
+	uint32_t dir = regs[DIOA_70DIR + 3*bank];
+	uint32_t out = regs[DIOA_70OUT + 3*bank];
+	int i, level = (bank == 2) ? 0 : 1;
+	uint64_t latest = 0;
+
+	if (dir & (1u << bit)) return (out >> bit) & 1;
+
+	if (bank == 1 && bit >= 4){
+		for (i = 0; i < nkeys; i++){
+			int col = keys[i].col;
+			if (keys[i].row == bit - 4 && now_ns >= keys[i].t0 && now_ns < keys[i].t1
+					&& (dir & (1u << col)) && !(out & (1u << col))){
+				return 0;
+			}
+		}
+	}
+	for (i = 0; i < nlevels; i++){
+		if (levels[i].bank == bank && levels[i].bit == bit
+				&& levels[i].t <= now_ns && levels[i].t >= latest){
+			latest = levels[i].t;
+			level = levels[i].level;
+		}
+	}
+	return level;
+}
+
+NiFpga_Bool Dio_ReadBit(MyRio_Dio *channel){
+	int bank = channel->dir / 3;
+	NiFpga_Bool b;
+	pthread_mutex_lock(&sim_lock);
+	tick(2);	// direction write, input read
+	regs[channel->dir] &= ~(1u << channel->bit);
+	b = dio_level(bank, channel->bit) ? NiFpga_True : NiFpga_False;
+	pthread_mutex_unlock(&sim_lock);
+	return b;
+}
+
+void Dio_WriteBit(MyRio_Dio *channel, NiFpga_Bool value){
+	int bank = channel->dir / 3;
+	pthread_mutex_lock(&sim_lock);
+	// the motor sees the old drive up to now
+	if (motor_on && motor.aio_chan < 0 && motor.bank == bank && motor.bit == channel->bit){
+		motor_update();
+	}
+	tick(2);	// output write, direction write
+	if (value) regs[channel->out] |= (1u << channel->bit);
+	else regs[channel->out] &= ~(1u << channel->bit);
+	regs[channel->dir] |= (1u << channel->bit);
+	pthread_mutex_unlock(&sim_lock);
+}
+
+/* AIO -------------------------------------------------------------------------*/
+void Sim_AioInit(MyRio_Aio *channel, Sim_AioChannel chan){
+	channel->chan = chan;
+}
+
+void Aio_InitCI0(MyRio_Aio *AIC0){ Sim_AioInit(AIC0, SIM_AI_C0); }
+void Aio_InitCI1(MyRio_Aio *AIC1){ Sim_AioInit(AIC1, SIM_AI_C1); }
+void Aio_InitCO0(MyRio_Aio *AOC0){ Sim_AioInit(AOC0, SIM_AO_C0); }
+void Aio_InitCO1(MyRio_Aio *AOC1){ Sim_AioInit(AOC1, SIM_AO_C1); }
+
+void sim_aio_source(int chan, sim_signal_fn fn, void *ctx){
+	if (chan < 0 || chan >= SIM_AIO_COUNT) return;
+	pthread_mutex_lock(&sim_lock);
+	aio_fn[chan] = fn;
+	aio_ctx[chan] = ctx;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+double sim_aio_output(int chan){
+	double v = 0;
+	if (chan < 0 || chan >= SIM_AIO_COUNT) return 0;
+	pthread_mutex_lock(&sim_lock);
+	v = aio_out[chan];
+	pthread_mutex_unlock(&sim_lock);
+	return v;
+}
+
+double sim_sine(double t, void *ctx){
+	Sim_Sine *s = (Sim_Sine*) ctx;
+	return s->offset + s->amplitude * sin(2*M_PI * s->freq * t);
+}
+
+double Aio_Read(MyRio_Aio *channel){
+/* source value at the current time, clipped and quantized like the 12 bit ADC */
+	double v = 0;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	if (aio_fn[channel->chan]){
+		v = aio_fn[channel->chan]((double)now_ns / SIM_NS_PER_S, aio_ctx[channel->chan]);
+	}
+	pthread_mutex_unlock(&sim_lock);
+	if (v > SIM_AIO_RANGE) v = SIM_AIO_RANGE;
+	if (v < -SIM_AIO_RANGE) v = -SIM_AIO_RANGE;
+	return round(v / SIM_AIO_STEP) * SIM_AIO_STEP;
+}
+
+void Aio_Write(MyRio_Aio *channel, double value){
+	if (value > SIM_AIO_RANGE) value = SIM_AIO_RANGE;
+	if (value < -SIM_AIO_RANGE) value = -SIM_AIO_RANGE;
+	pthread_mutex_lock(&sim_lock);
+	if (motor_on && motor.aio_chan == channel->chan) motor_update();
+	tick(2);	// value write, set
+	aio_out[channel->chan] = value;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+/* UART ------------------------------------------------------------------------*/
+int32_t Uart_Open(MyRio_Uart *port, uint32_t baud, uint8_t dataBits,
+		Uart_StopBits stopBits, Uart_Parity parity){
+	pthread_mutex_lock(&sim_lock);
+	uart_baud = baud ? baud : 19200;
+	port->session = 1;
+	pthread_mutex_unlock(&sim_lock);
+	return VI_SUCCESS;
+}
+
+int32_t Uart_Write(MyRio_Uart *port, const uint8_t *data, uint32_t nData){
+/* 10 bit times per byte (start, 8 data, stop) plus the per-call overhead */
+	sim_uart_fn fn;
+	void *ctx;
+	if (port->session == 0) return -1;
+	pthread_mutex_lock(&sim_lock);
+	advance_locked(now_ns + uart_call_cost
+			+ (uint64_t)nData * 10 * SIM_NS_PER_S / uart_baud);
+	uart_bytes += nData;
+	uart_calls++;
+	fn = uart_fn;
+	ctx = uart_ctx;
+	pthread_mutex_unlock(&sim_lock);
+	if (fn) fn(data, nData, ctx);
+	return VI_SUCCESS;
+}
+
+int32_t Uart_Clear(MyRio_Uart *port){
+	return VI_SUCCESS;
+}
+
+int32_t Uart_Close(MyRio_Uart *port){
+	port->session = 0;
+	return VI_SUCCESS;
+}
+
+void sim_uart_sink(sim_uart_fn fn, void *ctx){
+	pthread_mutex_lock(&sim_lock);
+	uart_fn = fn;
+	uart_ctx = ctx;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_set_uart_call_cost(uint64_t ns){
+	pthread_mutex_lock(&sim_lock);
+	uart_call_cost = ns;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+uint64_t sim_uart_bytes(void){
+	uint64_t n;
+	pthread_mutex_lock(&sim_lock);
+	n = uart_bytes;
+	pthread_mutex_unlock(&sim_lock);
+	return n;
+}
+
+uint64_t sim_uart_calls(void){
+	uint64_t n;
+	pthread_mutex_lock(&sim_lock);
+	n = uart_calls;
+	pthread_mutex_unlock(&sim_lock);
+	return n;
+}
+
+/* encoder and motor -----------------------------------------------------------*/
+NiFpga_Status EncoderC_initialize(NiFpga_Session myrio_session,
+		MyRio_Encoder *channel){
+	channel->index = 0;
+	return NiFpga_Status_Success;
+}
+
+void sim_encoder_source(int index, sim_count_fn fn, void *ctx){
+	if (index < 0 || index >= SIM_NUM_ENCODERS) return;
+	pthread_mutex_lock(&sim_lock);
+	enc_fn[index] = fn;
+	enc_ctx[index] = ctx;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void sim_motor(const Sim_Motor *m){
+	pthread_mutex_lock(&sim_lock);
+	motor = *m;
+	motor_on = 1;
+	motor_rpm = 0;
+	motor_counts = 0;
+	motor_t = now_ns;
+	pthread_mutex_unlock(&sim_lock);
+}
+
+static double motor_drive(void){
+/* drive voltage currently applied to the motor, lock held */
+	if (motor.aio_chan >= 0) return aio_out[motor.aio_chan];
+	return dio_level(motor.bank, motor.bit) ? motor.drive_v : 0;
+}
+
+static void motor_update(void){
+/* exact first order step response from motor_t to now, lock held
+ * The drive is constant over the step, so
+ * 	w(t) = w_ss + (w0 - w_ss) e^(-t/tau)
+ * and the angle is the integral of w. */
+	double dt, w_ss, decay;
+	if (!motor_on || now_ns <= motor_t) return;
+	dt = (double)(now_ns - motor_t) / SIM_NS_PER_S;
+	w_ss = motor.rpm_per_v * motor_drive();
+	decay = exp(-dt / motor.tau);
+	motor_counts += (w_ss*dt + (motor_rpm - w_ss)*motor.tau*(1 - decay))
+			* SIM_COUNTS_PER_REV / 60.0;
+	motor_rpm = w_ss + (motor_rpm - w_ss)*decay;
+	motor_t = now_ns;
+}
+
+uint32_t Encoder_Counter(MyRio_Encoder *channel){
+	uint32_t count = 0;
+	int i = channel->index;
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	if (enc_fn[i]){
+		count = enc_fn[i]((double)now_ns / SIM_NS_PER_S, enc_ctx[i]);
+	}
+	else if (motor_on && motor.encoder == i){
+		motor_update();
+		count = (uint32_t)(int64_t)floor(motor_counts);
+	}
+	pthread_mutex_unlock(&sim_lock);
+	return count;
+}
+
+/* IRQ -------------------------------------------------------------------------*/
+static int timer_context;		// handed out as the IRQ contexts
+static int di_context;
+
+int32_t Irq_RegisterTimerIrq(MyRio_IrqTimer *irqChannel,
+		NiFpga_IrqContext *irqContext, uint32_t timeout){
+	pthread_mutex_lock(&sim_lock);
+	thread_enter();	// the registering thread keeps running beside the ISR
+	regs[IRQTIMERWRITE] = timeout;
+	timer_deadline = now_ns + (uint64_t)timeout * SIM_NS_PER_US;
+	timer_armed = 1;
+	pthread_mutex_unlock(&sim_lock);
+	*irqContext = &timer_context;
+	return 0;
+}
+
+int32_t Irq_UnregisterTimerIrq(MyRio_IrqTimer *irqChannel,
+		NiFpga_IrqContext irqContext){
+	pthread_mutex_lock(&sim_lock);
+	timer_armed = 0;
+	irq_thread_set[TIMERIRQNO] = 0;
+	sync_changed();		// wake threads stopped at the deadline
+	pthread_mutex_unlock(&sim_lock);
+	return 0;
+}
+
+int32_t Irq_RegisterDiIrq(MyRio_IrqDi *irqChannel, NiFpga_IrqContext *irqContext,
+		uint8_t irqNumber, uint32_t count, Irq_Dio_Type type){
+	if (irqNumber == TIMERIRQNO || irqNumber >= SIM_NUM_IRQS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	thread_enter();
+	di_registered[irqNumber] = 1;
+	pthread_mutex_unlock(&sim_lock);
+	*irqContext = &di_context;
+	return 0;
+}
+
+int32_t Irq_UnregisterDiIrq(MyRio_IrqDi *irqChannel, NiFpga_IrqContext irqContext,
+		uint8_t irqNumber){
+	if (irqNumber >= SIM_NUM_IRQS) return -1;
+	pthread_mutex_lock(&sim_lock);
+	di_registered[irqNumber] = 0;
+	irq_thread_set[irqNumber] = 0;
+	sync_changed();
+	pthread_mutex_unlock(&sim_lock);
+	return 0;
+}
+
+void Irq_Wait(NiFpga_IrqContext irqContext, uint8_t irqNumber,
+		uint32_t *irqAssert, NiFpga_Bool *continueWaiting){
+/* wait for the next event of irqNumber on the virtual clock
+ * The thread is blocked until the clock reaches the event, moved by a
+ * register access or by step(). Until then *continueWaiting is looked at
+ * every SIM_POLL_NS of real time, like the timeout of the target's wait,
+ * and once it is false this returns with nothing asserted. */
+	int i;
+	uint64_t t;
+	Stall s;
+
+	*irqAssert = 0;
+	if (irqNumber >= SIM_NUM_IRQS) return;
+
+	pthread_mutex_lock(&sim_lock);
+	thread_enter();
+	irq_thread[irqNumber] = pthread_self();
+	irq_thread_set[irqNumber] = 1;
+	if (isr_body){
+		isr_body = 0;
+		isr_running--;
+	}
+	threads_blocked++;
+	sync_changed();
+	stall_start(&s);
+	while (*continueWaiting == NiFpga_True){
+		if (!(irq_event(irqNumber, &t) && t <= now_ns)){
+			step();
+		}
+		if (irq_event(irqNumber, &t) && t <= now_ns){
+			if (irqNumber == TIMERIRQNO){
+				timer_armed = 0;
+			}
+			else{
+				for (i = next_edge; edges[i].irq != irqNumber; i++){}
+				for (; i > next_edge; i--) edges[i] = edges[i-1];
+				next_edge++;
+			}
+			*irqAssert = 1u << irqNumber;
+			irq_counts[irqNumber]++;
+			break;
+		}
+		wait_locked(&s, "Irq_Wait");
+	}
+	threads_blocked--;
+	isr_body = 1;		// back in the service body until the next Irq_Wait()
+	isr_running++;
+	sync_changed();
+	pthread_mutex_unlock(&sim_lock);
+}
+
+void Irq_Acknowledge(uint32_t irqAssert){
+	pthread_mutex_lock(&sim_lock);
+	tick(1);
+	pthread_mutex_unlock(&sim_lock);
+}
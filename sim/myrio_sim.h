@@ -0,0 +1,120 @@
+/*
+ * myrio_sim.h
+ * Author: Trenton
+ * Date: 03/21/25
+ * Description: Controls for the host-side simulated myRIO.
+ *
+ * The simulation runs on a virtual clock in nanoseconds that starts at 0
+ * when the program starts. Only the waits read the host clock, to look at
+ * a stop flag and to stop the run if the clock is stuck, so a run with the
+ * same script takes the same IRQ events at the same times every time. Time
+ * moves forward when:
+ * 	-an FPGA register access is made (sim_set_access_cost(), default 2 us)
+ * 	-bytes are written to the UART (per-call cost + 10 bits per byte)
+ * 	-a program calls sim_advance(), or every known thread is blocked and
+ * 	 the clock jumps to the next sleep end, timer deadline or DI edge
+ *
+ * MyRio_Open() does not touch the simulation, so a host harness can set up
+ * its scripts and then call the lab's main(). sim_reset() clears everything.
+ *
+ * A thread counts for the clock from its first call into the simulation
+ * until it exits or unregisters. Known threads take turns: sleeps,
+ * sim_sem_wait(), sim_join() and Irq_Wait() block in the simulation, and
+ * only once every known thread is blocked does the clock jump and one of
+ * them go on. A known thread blocked outside it (on a plain semaphore or
+ * join) keeps the clock where it is. rt_thread_create() registers its
+ * thread as an ISR before it starts, the other threads then wait for it
+ * to get to its first Irq_Wait(), as they would on the target where it
+ * preempts them.
+ */
+
+#ifndef MYRIO_SIM_H
+#define MYRIO_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#define SIM_NS_PER_US 1000ULL
+#define SIM_NS_PER_MS 1000000ULL
+#define SIM_NS_PER_S  1000000000ULL
+
+/* virtual clock */
+void sim_reset(void);					// clear scripts, sources, counters and clock
+uint64_t sim_now(void);					// current virtual time (ns)
+void sim_advance(uint64_t ns);			// move the clock forward
+void sim_advance_to(uint64_t t_ns);		// move the clock to t_ns if it is ahead
+// wait for other threads to move it to t_ns, or for *run to be 0
+void sim_wait_until(uint64_t t_ns, atomic_int *run);
+void sim_set_access_cost(uint64_t ns);	// virtual cost of one register access
+
+/* threads taking part in the timing, called first by the new thread, which
+ * posts ready for its creator. isr = 1: holds the others until it waits in
+ * Irq_Wait(), isr = 0: starts blocked, at a set point of virtual time */
+void sim_thread_register(int isr, sem_t *ready);
+void sim_thread_unregister(void);
+
+/* a semaphore handoff the clock knows about: the woken thread runs at the
+ * virtual time of the post */
+void sim_sem_wait(sem_t *s);
+void sim_sem_post(sem_t *s);
+int sim_join(pthread_t t);		// pthread_join(), blocked if t is known
+
+/* keypad on connector B: columns DIOB 0-3 are driven, rows DIOB 4-7 are read */
+// hold key down from at_ns for hold_ns
+void sim_keypad_press(char key, uint64_t at_ns, uint64_t hold_ns);
+// type the keys in order, one every gap_ns starting at start_ns
+void sim_keypad_type(const char *keys, uint64_t start_ns, uint64_t gap_ns,
+		uint64_t hold_ns);
+int sim_keypad_pending(void);	// scripted presses not yet released
+
+/* digital input levels, bank 0-2 is connector A-C */
+void sim_dio_level(int bank, int bit, uint64_t at_ns, int level);
+
+/* DI interrupt edges, delivered to Irq_Wait() for the registered IRQ number */
+void sim_di_edge(uint8_t irqNumber, uint64_t at_ns);
+
+/* UART sink, called with the bytes of every Uart_Write() */
+typedef void (*sim_uart_fn)(const uint8_t *data, size_t n, void *ctx);
+void sim_uart_sink(sim_uart_fn fn, void *ctx);
+void sim_set_uart_call_cost(uint64_t ns);	// per Uart_Write overhead, default 50 us
+uint64_t sim_uart_bytes(void);	// bytes written since sim_reset()
+uint64_t sim_uart_calls(void);	// Uart_Write calls since sim_reset()
+
+/* analog signal sources, t is virtual time in seconds */
+typedef double (*sim_signal_fn)(double t, void *ctx);
+void sim_aio_source(int chan, sim_signal_fn fn, void *ctx);
+double sim_aio_output(int chan);	// last value written to an output channel
+
+typedef struct {
+	double amplitude;	// volts
+	double freq;		// Hz
+	double offset;		// volts
+} Sim_Sine;
+double sim_sine(double t, void *ctx);	// sim_signal_fn for a Sim_Sine
+
+/* encoder counters */
+typedef uint32_t (*sim_count_fn)(double t, void *ctx);
+void sim_encoder_source(int index, sim_count_fn fn, void *ctx);
+
+/* first order DC motor turning an encoder at 2048 counts per revolution.
+ * Drive is the analog output aio_chan (volts), or if aio_chan < 0 the
+ * DIO pin bank/bit switching between 0 and drive_v. */
+typedef struct {
+	int encoder;		// encoder index
+	int aio_chan;		// Sim_AioChannel of the drive, or -1
+	int bank;			// DIO drive bank when aio_chan < 0
+	int bit;			// DIO drive bit when aio_chan < 0
+	double drive_v;		// DIO drive voltage when pin is high
+	double rpm_per_v;	// steady state gain
+	double tau;			// time constant (s)
+} Sim_Motor;
+void sim_motor(const Sim_Motor *motor);
+
+/* counters */
+uint64_t sim_irq_count(uint8_t irqNumber);	// IRQs delivered since sim_reset()
+uint64_t sim_access_count(void);			// register accesses since sim_reset()
+
+#endif
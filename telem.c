@@ -0,0 +1,158 @@
+/*
+ * telem.c
+ * Author: Trenton
+ * Date: 06/13/25
+ * Description: Telemetry stream, see telem.h.
+ *
+ * Ring: single producer (the real time thread) / single consumer (the
+ * writer thread), same scheme as the keypad queue. The producer copies the
+ * record in and publishes it with a release store of head; the writer
+ * reads head with acquire, passes the records to the sink where they lie
+ * (at most two runs per drain, before and after the wrap) and then gives
+ * the slots back with a release store of tail.
+ *
+ * started is set once the writer runs. A Telem that never got that far (a
+ * static one whose file didn't open, or a failed open/start) takes pushes
+ * and closes and does nothing with them, so a lab that carries on without
+ * its capture file doesn't fill a ring nobody drains or join a thread that
+ * doesn't exist.
+ */
+
+/* includes */
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "timing.h"
+#include "telem.h"
+
+/* definitions */
+#define RMASK (TELEM_RING - 1)
+
+/* prototypes */
+static void* telem_thread(void *arg);
+
+// Functions ###################################################################
+
+int telem_start(Telem *t, int nch, Telem_Write write, Telem_Close close, void *ctx){
+	t->started = 0;
+	if (nch < 1 || nch > TELEM_MAXCH) return -1;
+	t->nch = nch;
+	t->write = write;
+	t->close = close;
+	t->ctx = ctx;
+	t->error = 0;
+	atomic_init(&t->head, 0);
+	atomic_init(&t->tail, 0);
+	atomic_init(&t->dropped, 0);
+	atomic_init(&t->running, 1);
+	if (pthread_create(&t->writer, NULL, telem_thread, t) != 0){
+		atomic_store(&t->running, 0);
+		return -1;
+	}
+	t->started = 1;
+	return 0;
+}
+
+int telem_push(Telem *t, uint64_t time, const double *v){
+/* real time thread: no locks, no system calls */
+	unsigned h = atomic_load_explicit(&t->head, memory_order_relaxed);
+	unsigned tl = atomic_load_explicit(&t->tail, memory_order_acquire);
+	Telem_Rec *r;
+	int i;
+	if (!t->started) return -1;
+	if (h - tl >= TELEM_RING){
+		atomic_fetch_add_explicit(&t->dropped, 1, memory_order_relaxed);
+		return -1;
+	}
+	r = &t->ring[h & RMASK];
+	r->t = time;
+	for (i = 0; i < t->nch; i++) r->v[i] = v[i];
+	atomic_store_explicit(&t->head, h + 1, memory_order_release);
+	return 0;
+}
+
+static void drain(Telem *t){
+/* everything queued so far to the sink */
+	unsigned h = atomic_load_explicit(&t->head, memory_order_acquire);
+	unsigned tl = atomic_load_explicit(&t->tail, memory_order_relaxed);
+	unsigned n;
+	while (tl != h){
+		n = h - tl;
+		if (n > TELEM_RING - (tl & RMASK)) n = TELEM_RING - (tl & RMASK);	// up to the wrap
+		if (!t->error && t->write(t->ctx, &t->ring[tl & RMASK], n) < 0) t->error = 1;
+		tl += n;
+		atomic_store_explicit(&t->tail, tl, memory_order_release);
+	}
+}
+
+static void* telem_thread(void *arg){
+/* the period needn't be exact, each wait is from now */
+	Telem *t = arg;
+	while (atomic_load(&t->running)){
+		drain(t);
+		timing_wait_until(timing_now() + TELEM_PERIOD_NS, &t->running);
+	}
+	return NULL;
+}
+
+int telem_close(Telem *t){
+	if (!t->started) return 0;
+	t->started = 0;
+	atomic_store(&t->running, 0);
+	pthread_join(t->writer, NULL);
+	drain(t);	// what came in after the last pass
+	if (t->close && t->close(t->ctx) < 0) t->error = 1;
+	return t->error ? -1 : 0;
+}
+
+uint32_t telem_dropped(Telem *t){
+	return atomic_load(&t->dropped);
+}
+
+/* file sink ----------------------------------------------------------------*/
+static int flush_buf(Telem *t){
+	int off = 0, w;
+	while (off < t->nbuf){
+		w = write(t->fd, t->buf + off, t->nbuf - off);
+		if (w < 0) return -1;
+		off += w;
+	}
+	t->nbuf = 0;
+	return 0;
+}
+
+static int file_write(void *ctx, const Telem_Rec *r, int n){
+/* packs t and the nch values used, one write() per full buffer */
+	Telem *t = ctx;
+	int size = 8 + 8*t->nch, i;
+	for (i = 0; i < n; i++){
+		if (t->nbuf + size > TELEM_CHUNK && flush_buf(t) < 0) return -1;
+		memcpy(t->buf + t->nbuf, &r[i].t, 8);
+		memcpy(t->buf + t->nbuf + 8, r[i].v, 8*t->nch);
+		t->nbuf += size;
+	}
+	return 0;
+}
+
+static int file_close(void *ctx){
+	Telem *t = ctx;
+	int status = flush_buf(t);
+	if (close(t->fd) < 0) status = -1;
+	return status;
+}
+
+int telem_open(Telem *t, const char *file, int nch){
+	uint32_t n = nch;
+	t->started = 0;
+	if (nch < 1 || nch > TELEM_MAXCH) return -1;
+	t->fd = open(file, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (t->fd < 0) return -1;
+	memcpy(t->buf, "TLM1", 4);
+	memcpy(t->buf + 4, &n, 4);
+	t->nbuf = 8;
+	if (telem_start(t, nch, file_write, file_close, t) < 0){
+		close(t->fd);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * telem.h
+ * Author: Trenton
+ * Date: 06/13/25
+ * Description: Telemetry stream for long captures.
+ * The labs log into static arrays that stop filling when they are full and
+ * only reach the disk at shutdown. Here the real time thread pushes fixed
+ * size records (a time stamp and up to TELEM_MAXCH values) into a lock
+ * free ring and returns, and a writer thread drains the ring every
+ * TELEM_PERIOD_NS and hands whole runs of records to a sink. RAM use is
+ * the ring, whatever the length of the run, and the real time thread
+ * never does file I/O. A full ring drops the new record and counts it.
+ *
+ * telem_open() uses the built in file sink: the records are packed into a
+ * TELEM_CHUNK byte buffer that goes out with one write() when full.
+ * File layout, little endian:
+ * 	"TLM1", uint32 nch, then per record uint64 t (ns), double v[nch]
+ * telem_start() takes any other sink.
+ *
+ * A zeroed (static) Telem that never started, because its file couldn't
+ * be opened, can still be pushed to and closed: both do nothing.
+ */
+
+#ifndef TELEM_H
+#define TELEM_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define TELEM_MAXCH 6				// values per record
+#define TELEM_RING 8192				// records in the ring, power of 2
+#define TELEM_PERIOD_NS 50000000ULL	// writer drains every 50 ms
+#define TELEM_CHUNK 65536			// file sink buffer (bytes)
+
+/* one sample record */
+typedef struct {
+	uint64_t t;					// timing_now() (ns)
+	double v[TELEM_MAXCH];		// values, nch of them used
+} Telem_Rec;
+
+/* sink: n records, called on the writer thread, returns 0 or -1 */
+typedef int (*Telem_Write)(void *ctx, const Telem_Rec *r, int n);
+/* end of the stream, called on close after the last write */
+typedef int (*Telem_Close)(void *ctx);
+
+typedef struct {
+	int nch;					// values per record in use
+	Telem_Rec ring[TELEM_RING];
+	atomic_uint head;			// written by the producer
+	atomic_uint tail;			// written by the writer thread
+	atomic_uint dropped;		// records lost to a full ring
+	atomic_int running;			// writer thread keep-going flag
+	pthread_t writer;
+	Telem_Write write;			// sink
+	Telem_Close close;
+	void *ctx;
+	int error;					// a sink call failed
+	int started;				// writer running, push and close act on it
+	int fd;						// file sink
+	int nbuf;					// file sink bytes in buf
+	uint8_t buf[TELEM_CHUNK];
+} Telem;
+
+int telem_open(Telem *t, const char *file, int nch);	// file sink, -1 on error
+int telem_start(Telem *t, int nch, Telem_Write write, Telem_Close close, void *ctx);
+int telem_push(Telem *t, uint64_t time, const double *v);	// 0, or -1 if dropped or not started
+int telem_close(Telem *t);		// drain, stop the writer, close the sink, 0 or -1 (0 if not started)
+uint32_t telem_dropped(Telem *t);
+
+#endif
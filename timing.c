@@ -0,0 +1,151 @@
+/*
+ * timing.c
+ * Author: Trenton
+ * Date: 03/28/25
+ * Description: Deadline based timing service, see timing.h.
+ * Uses CLOCK_MONOTONIC and clock_nanosleep() with TIMER_ABSTIME, so a
+ * sleep that is interrupted by a signal just goes back to sleep until the
+ * same deadline.
+ */
+
+/* includes */
+#include <time.h>
+#include <errno.h>
+#include "MyRio.h"
+#include "timing.h"
+
+#ifdef MYRIO_SIM
+/* start-up handshake, on the creator's stack */
+typedef struct {
+	void *(*fn)(void*);
+	void *arg;
+	sem_t ready;	// registered with the clock, fn and arg copied
+} Start;
+#endif
+
+// Functions ###################################################################
+
+uint64_t timing_now(void){
+/* monotonic time in ns, the virtual clock on the host simulation */
+#ifdef MYRIO_SIM
+	return sim_now();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * TIMING_NS_PER_S + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+uint64_t timing_elapsed(uint64_t start){
+	return timing_now() - start;
+}
+
+void timing_sleep_until(uint64_t deadline){
+/* returns right away if the deadline has passed */
+#ifdef MYRIO_SIM
+	sim_advance_to(deadline);
+#else
+	struct timespec ts;
+	ts.tv_sec = deadline / TIMING_NS_PER_S;
+	ts.tv_nsec = deadline % TIMING_NS_PER_S;
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR){}
+#endif
+}
+
+void timing_wait_until(uint64_t deadline, atomic_int *run){
+/* a background thread's wait, it doesn't hold the virtual clock back or
+ * push it ahead of the threads that do the timing */
+#ifdef MYRIO_SIM
+	sim_wait_until(deadline, run);
+#else
+	timing_sleep_until(deadline);
+#endif
+}
+
+#ifdef MYRIO_SIM
+static void* start(void *p){
+	Start *s = p;
+	void *(*fn)(void*) = s->fn;
+	void *arg = s->arg;
+	void *r;
+	sim_thread_register(0, &s->ready);	// s is gone after this
+	r = fn(arg);
+	sim_thread_unregister();
+	return r;
+}
+#endif
+
+int timing_thread_create(pthread_t *t, void *(*fn)(void*), void *arg){
+/* pthread_create() with default attributes, on the host simulation the new
+ * thread is counted for the clock before this returns */
+#ifdef MYRIO_SIM
+	Start s;
+	int r;
+	s.fn = fn;
+	s.arg = arg;
+	if (sem_init(&s.ready, 0, 0) != 0) return -1;
+	r = pthread_create(t, NULL, start, &s);
+	if (r == 0) sem_wait(&s.ready);
+	sem_destroy(&s.ready);
+	return r;
+#else
+	return pthread_create(t, NULL, fn, arg);
+#endif
+}
+
+void timing_sem_wait(sem_t *s){
+#ifdef MYRIO_SIM
+	sim_sem_wait(s);
+#else
+	while (sem_wait(s) != 0){}
+#endif
+}
+
+void timing_sem_post(sem_t *s){
+#ifdef MYRIO_SIM
+	sim_sem_post(s);
+#else
+	sem_post(s);
+#endif
+}
+
+int timing_join(pthread_t t){
+/* pthread_join(), on the host simulation the caller is blocked for the
+ * clock while it waits */
+#ifdef MYRIO_SIM
+	return sim_join(t);
+#else
+	return pthread_join(t, NULL);
+#endif
+}
+
+void timing_sleep(uint64_t ns){
+	timing_sleep_until(timing_now() + ns);
+}
+
+void tick_start(Tick *t, uint64_t period){
+	t->period = period;
+	t->missed = 0;
+	t->next = timing_now() + period;
+}
+
+int tick_wait(Tick *t){
+/*
+ * Sleeps until the next tick and schedules the one after it.
+ * The next deadline is the last deadline + period, never now + period,
+ * so a loop body of any length (shorter than a period) causes no drift.
+ * If the loop ran past one or more deadlines, those ticks are skipped
+ * rather than run back to back, and the number skipped is returned.
+ */
+	int missed = 0;
+	uint64_t now = timing_now();
+
+	if (now >= t->next + t->period){
+		missed = (int)((now - t->next) / t->period);
+		t->next += (uint64_t)missed * t->period;
+		t->missed += missed;
+	}
+	timing_sleep_until(t->next);
+	t->next += t->period;
+	return missed;
+}
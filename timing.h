@@ -0,0 +1,56 @@
+/*
+ * timing.h
+ * Author: Trenton
+ * Date: 03/28/25
+ * Description: Timing service built on absolute monotonic deadlines.
+ * Replaces the calibrated count-down wait loops (wait(), wait2(), wait5()).
+ * Sleeping frees the CPU, and because each periodic tick is computed from
+ * the previous deadline instead of from "now", the error does not add up
+ * over a long run.
+ *
+ * On the host simulation (MYRIO_SIM) the virtual clock is used instead.
+ * Sleeping moves it forward, except in timing_wait_until(), which waits
+ * for the other threads to move it. A thread that sleeps or does I/O is
+ * started with timing_thread_create(), so the clock counts it before it
+ * runs. Work handed over through a semaphore uses timing_sem_post() and
+ * timing_sem_wait(), so the woken thread runs at the virtual time of the
+ * post, and such a thread is joined with timing_join(), so the caller is
+ * blocked while it finishes.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <semaphore.h>
+
+#define TIMING_NS_PER_US 1000ULL
+#define TIMING_NS_PER_MS 1000000ULL
+#define TIMING_NS_PER_S  1000000000ULL
+
+/* periodic tick state, one per loop */
+typedef struct {
+	uint64_t next;		// absolute deadline of the next tick (ns)
+	uint64_t period;	// tick period (ns)
+	uint32_t missed;	// ticks skipped because the loop ran late
+} Tick;
+
+uint64_t timing_now(void);					// monotonic time (ns)
+uint64_t timing_elapsed(uint64_t start);	// ns since start
+void timing_sleep_until(uint64_t deadline);	// sleep to an absolute time
+void timing_sleep(uint64_t ns);				// sleep ns from now
+// sleep_until for background threads, may return early once *run is 0
+void timing_wait_until(uint64_t deadline, atomic_int *run);
+
+/* threads and waits on them that the virtual clock has to know about */
+int timing_thread_create(pthread_t *t, void *(*fn)(void*), void *arg);
+void timing_sem_wait(sem_t *s);		// sem_wait(), retried if interrupted
+void timing_sem_post(sem_t *s);
+int timing_join(pthread_t t);		// pthread_join() of a thread that sleeps
+
+void tick_start(Tick *t, uint64_t period);	// first tick one period from now
+int tick_wait(Tick *t);	// sleep to the next tick, returns ticks missed
+
+#endif
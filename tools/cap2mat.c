@@ -0,0 +1,96 @@
+/*
+ * cap2mat.c
+ * Author: Trenton
+ * Date: 06/27/25
+ * Description: Host tool, converts a capture file (capture.h) to a MAT
+ * file. Every column becomes an n x 1 double variable with the column's
+ * name, t in seconds. The columns are read in place from the mapped file
+ * (capread.c) and streamed out a block at a time (matstream.c), double
+ * columns go straight from the map to the write buffer. With -i it only
+ * prints the schema, the row count and the first and last rows.
+ *
+ *   gcc -O2 -Isim -I. tools/cap2mat.c capread.c matstream.c telem.c timing.c sim/myrio_sim.c -lpthread -lm
+ *   ./a.out Lab6_trenton.cap Lab6_trenton_run.mat
+ *   ./a.out -i Lab6_trenton.cap
+ */
+
+/* includes */
+#include <stdio.h>
+#include <string.h>
+#include "capread.h"
+#include "matstream.h"
+
+/* definitions */
+static Mat_Stream ms;
+
+// Functions ###################################################################
+
+static void info(const Cap_File *f){
+	Cap_View v;
+	int i;
+	printf("%llu rows, %u per block\n", (unsigned long long)f->rows, f->block_rows);
+	for (i = 0; i < f->ncol; i++){
+		v = cap_view(f, i);
+		printf("  %-12.*s %s", CAP_NAME, f->col[i].name,
+				v.type == CAP_U64 ? "u64" : v.type == CAP_F32 ? "f32" : "f64");
+		if (f->rows > 0) printf("  %-12g ... %g", cap_get(&v, 0), cap_get(&v, f->rows - 1));
+		printf("\n");
+	}
+}
+
+static int put_column(const Cap_File *f, int col){
+/* the column in runs of up to one block */
+	Cap_View v = cap_view(f, col);
+	static double d[CAP_ROWS];
+	char name[CAP_NAME + 1];
+	const void *p;
+	uint64_t i = 0;
+	uint32_t n, k;
+	memcpy(name, f->col[col].name, CAP_NAME);
+	name[CAP_NAME] = '\0';
+	if (mats_begin(&ms, name, 1) < 0) return -1;
+	while ((p = cap_run(&v, i, &n)) != NULL){
+		if (v.type == CAP_F64) mats_append(&ms, p, n);
+		else {
+			for (k = 0; k < n && k < CAP_ROWS; k++) d[k] = cap_get(&v, i + k);
+			mats_append(&ms, d, k);
+			n = k;
+		}
+		i += n;
+	}
+	return mats_end(&ms);
+}
+
+int main(int argc, char **argv){
+	Cap_File f;
+	int i;
+	if (argc == 3 && strcmp(argv[1], "-i") == 0){
+		if (cap_map(&f, argv[2]) < 0){
+			printf("%s: not a capture file\n", argv[2]);
+			return 1;
+		}
+		info(&f);
+		cap_unmap(&f);
+		return 0;
+	}
+	if (argc != 3){
+		printf("usage: cap2mat file.cap file.mat | cap2mat -i file.cap\n");
+		return 1;
+	}
+	if (cap_map(&f, argv[1]) < 0){
+		printf("%s: not a capture file\n", argv[1]);
+		return 1;
+	}
+	if (mats_open(&ms, argv[2]) < 0){
+		printf("can't open %s\n", argv[2]);
+		return 1;
+	}
+	for (i = 0; i < f.ncol; i++) put_column(&f, i);
+	cap_unmap(&f);
+	if (mats_close(&ms) < 0){
+		printf("%s: write failed\n", argv[2]);
+		return 1;
+	}
+	printf("%s: %d columns x %llu rows\n", argv[2], f.ncol, (unsigned long long)f.rows);
+	return 0;
+}
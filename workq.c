@@ -0,0 +1,115 @@
+/*
+ * workq.c
+ * Author: Trenton
+ * Date: 08/08/25
+ * Description: Deferred work queue, see workq.h.
+ * Single producer, single consumer ring like telem.c: head is written only
+ * by the poster, tail only by the worker, both count up forever and are
+ * masked into ring[]. The worker runs a job straight out of its slot and
+ * moves tail past it afterwards, so the poster can't reuse the slot while
+ * the job is still reading its values.
+ *
+ * The worker sleeps on a semaphore (through timing.c, so the host
+ * simulation knows), sem_post() doesn't block. It runs at
+ * the lowest priority the system allows, like the LCD writer
+ * (lcd_async.c), so a job never delays the thread that posted it.
+ *
+ * If the worker can't be started, workq_post() runs the job right away on
+ * the poster's thread, so nothing is lost but the poster waits for it,
+ * and workq_stop() has nothing to do.
+ */
+
+/* includes */
+#include <sched.h>
+#include "timing.h"
+#include "workq.h"
+
+/* definitions */
+#define MASK (WORKQ_SIZE - 1)
+
+/* prototypes */
+static void* workq_thread(void *arg);
+
+// Functions ###################################################################
+
+int workq_start(Workq *q){
+	atomic_init(&q->head, 0);
+	atomic_init(&q->tail, 0);
+	atomic_init(&q->dropped, 0);
+	atomic_init(&q->running, 1);
+	q->started = 0;
+	if (sem_init(&q->wake, 0, 0) != 0) return -1;
+	if (timing_thread_create(&q->worker, workq_thread, q) != 0){
+		sem_destroy(&q->wake);
+		return -1;
+	}
+	q->started = 1;
+#ifdef SCHED_IDLE
+	{
+		struct sched_param sp = {0};
+		pthread_setschedparam(q->worker, SCHED_IDLE, &sp);	// best effort
+	}
+#endif
+	return 0;
+}
+
+int workq_post(Workq *q, Workq_Fn fn, void *ctx, const Workq_Arg *arg){
+/* poster thread: no locks, no waiting */
+	unsigned h = atomic_load_explicit(&q->head, memory_order_relaxed);
+	unsigned t = atomic_load_explicit(&q->tail, memory_order_acquire);
+	Workq_Job *j;
+	if (!q->started){
+		fn(ctx, arg);	// no worker, run it here
+		return 0;
+	}
+	if (h - t >= WORKQ_SIZE){
+		atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+		return -1;
+	}
+	j = &q->ring[h & MASK];
+	j->fn = fn;
+	j->ctx = ctx;
+	j->arg = *arg;
+	atomic_store_explicit(&q->head, h + 1, memory_order_release);
+	timing_sem_post(&q->wake);
+	return 0;
+}
+
+static void run_all(Workq *q){
+/* every job posted so far, in order */
+	unsigned h = atomic_load_explicit(&q->head, memory_order_acquire);
+	unsigned t = atomic_load_explicit(&q->tail, memory_order_relaxed);
+	Workq_Job *j;
+	for (; t != h; t++){
+		j = &q->ring[t & MASK];
+		j->fn(j->ctx, &j->arg);
+		atomic_store_explicit(&q->tail, t + 1, memory_order_release);
+	}
+}
+
+static void* workq_thread(void *arg){
+	Workq *q = arg;
+	while (atomic_load(&q->running)){
+		timing_sem_wait(&q->wake);
+		run_all(q);
+	}
+	return NULL;
+}
+
+void workq_stop(Workq *q){
+	if (!q->started) return;
+	q->started = 0;
+	atomic_store(&q->running, 0);
+	timing_sem_post(&q->wake);
+	timing_join(q->worker);
+	run_all(q);		// posted after the worker's last pass
+	sem_destroy(&q->wake);
+}
+
+uint32_t workq_pending(Workq *q){
+	return atomic_load(&q->head) - atomic_load(&q->tail);
+}
+
+uint32_t workq_dropped(Workq *q){
+	return atomic_load(&q->dropped);
+}
@@ -0,0 +1,63 @@
+/*
+ * workq.h
+ * Author: Trenton
+ * Date: 08/08/25
+ * Description: Deferred work queue.
+ * A time critical loop (an FSM tick, an ISR) hands slow work such as an
+ * LCD print or a buffer append to a low priority worker thread instead of
+ * doing it in the tick. workq_post() copies a job (a function, a context
+ * pointer and a Workq_Arg: WORKQ_ARGS values and a time stamp) into a
+ * lock free ring, wakes the worker and returns. It never blocks or
+ * allocates, so it takes the same short time every call. When the ring is
+ * full the job is dropped and counted.
+ *
+ * Jobs run one at a time on the worker, in the order posted. Only one
+ * thread may post. A job's function runs on the worker thread, so what it
+ * touches (a buffer, the LCD, a telemetry stream) should be left to the
+ * worker until workq_stop() has run the last job.
+ */
+
+#ifndef WORKQ_H
+#define WORKQ_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+#define WORKQ_SIZE 64		// jobs in the ring, power of 2
+#define WORKQ_ARGS 4		// values carried by a job
+
+/* what a job carries, copied in whole */
+typedef struct {
+	uint64_t t;				// a time stamp (ns), e.g. when the values were taken
+	double v[WORKQ_ARGS];	// values
+} Workq_Arg;
+
+/* a job: fn(ctx, arg) on the worker thread */
+typedef void (*Workq_Fn)(void *ctx, const Workq_Arg *arg);
+
+typedef struct {
+	Workq_Fn fn;
+	void *ctx;
+	Workq_Arg arg;
+} Workq_Job;
+
+typedef struct {
+	Workq_Job ring[WORKQ_SIZE];
+	atomic_uint head;		// next job to post (poster)
+	atomic_uint tail;		// next job to run (worker)
+	atomic_uint dropped;	// jobs dropped, ring full
+	atomic_int running;		// worker keep-going flag
+	sem_t wake;				// jobs posted
+	pthread_t worker;
+	int started;			// worker running, else jobs run on post
+} Workq;
+
+int workq_start(Workq *q);		// start the worker, 0 or -1 (jobs then run on post)
+void workq_stop(Workq *q);		// run the jobs still queued and join the worker, if started
+int workq_post(Workq *q, Workq_Fn fn, void *ctx, const Workq_Arg *arg);	// 0 or -1
+uint32_t workq_pending(Workq *q);	// jobs posted and not yet run
+uint32_t workq_dropped(Workq *q);
+
+#endif